@@ -0,0 +1,249 @@
+#include <benchmark/benchmark.h>
+
+#include "batch_kernels.h"
+#include "collision.h"
+#include "crafting.h"
+#include "engine.h"
+#include "fixed_point.h"
+#include "rng.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+// Counts heap allocations so benchmarks can check that a code path does not allocate.
+static thread_local size_t allocationCount = 0;
+
+void* operator new(size_t size) {
+    ++allocationCount;
+    if (void* memory = std::malloc(size != 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+static void BM_Lerp(benchmark::State& state) {
+    EVec start = {0.0f, 0.0f};
+    EVec end = {1920.0f, 1080.0f};
+    float t = 0.1f;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(start);
+        benchmark::DoNotOptimize(end);
+        EVec result = Lerp(start, end, t);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_Lerp);
+
+static void BM_LerpFixed(benchmark::State& state) {
+    FixedVec start = {Fixed(0), Fixed(0)};
+    FixedVec end = {Fixed(1920), Fixed(1080)};
+    Fixed t(0.1f);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(start);
+        benchmark::DoNotOptimize(end);
+        FixedVec result = Lerp(start, end, t);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_LerpFixed);
+
+// Interpolating range(0) entities one at a time, as the per-entity code does.
+static void BM_LerpEntities(benchmark::State& state) {
+    std::vector<EVec> positions(size_t(state.range(0)), EVec{0.0f, 0.0f});
+    std::vector<EVec> targets(size_t(state.range(0)), EVec{1920.0f, 1080.0f});
+    for (auto _ : state) {
+        for (size_t i = 0; i < positions.size(); ++i) {
+            positions[i] = Lerp(positions[i], targets[i], 0.1f);
+        }
+        benchmark::DoNotOptimize(positions.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_LerpEntities)->RangeMultiplier(8)->Range(64, 32768);
+
+// The same with the batch kernel.
+static void BM_BatchLerp(benchmark::State& state) {
+    std::vector<EVec> positions(size_t(state.range(0)), EVec{0.0f, 0.0f});
+    std::vector<EVec> targets(size_t(state.range(0)), EVec{1920.0f, 1080.0f});
+    for (auto _ : state) {
+        batchLerp(positions, targets, 0.1f);
+        benchmark::DoNotOptimize(positions.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+    state.SetLabel(batchKernelImplementation());
+}
+BENCHMARK(BM_BatchLerp)->RangeMultiplier(8)->Range(64, 32768);
+
+static void BM_BatchTranslateClamp(benchmark::State& state) {
+    std::vector<EVec> positions(size_t(state.range(0)), EVec{0.0f, 0.0f});
+    std::vector<EVec> deltas(size_t(state.range(0)), EVec{1.5f, -2.5f});
+    for (auto _ : state) {
+        batchTranslate(positions, deltas);
+        batchClamp(positions, EVec{-1000.0f, -1000.0f}, EVec{1000.0f, 1000.0f});
+        benchmark::DoNotOptimize(positions.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+    state.SetLabel(batchKernelImplementation());
+}
+BENCHMARK(BM_BatchTranslateClamp)->RangeMultiplier(8)->Range(64, 32768);
+
+// Integrating one movement input per player in fixed point, as the server tick does.
+static void BM_BatchApplyMovement(benchmark::State& state) {
+    std::vector<WorldVec> positions(size_t(state.range(0)), WorldVec{WorldFixed(960), WorldFixed(540)});
+    std::vector<WorldVec> deltas(size_t(state.range(0)), toFixed<WorldFixed>(EVec{1.5f, -2.5f}));
+    for (auto _ : state) {
+        batchApplyMovement(positions, deltas);
+        benchmark::DoNotOptimize(positions.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+    state.SetLabel(batchKernelImplementation());
+}
+BENCHMARK(BM_BatchApplyMovement)->RangeMultiplier(8)->Range(64, 32768);
+
+static void BM_PlayerEntityMove(benchmark::State& state) {
+    PlayerEntity player("Player", PlayerColor{255, 0, 0, 255}, EVec{960.0f, 540.0f}, 1.0f, Inventory(9, 3));
+    EVec target = {1000.0f, 600.0f};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(target);
+        player.move(target);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_PlayerEntityMove);
+
+// What UI and replication code reads from the player every frame. Fails if any of it allocates.
+static void BM_PlayerEntityReadAccess(benchmark::State& state) {
+    PlayerEntity player("A player name longer than the small string buffer", PlayerColor{255, 0, 0, 255}, EVec{960.0f, 540.0f}, 1.0f,
+                        Inventory(4, 9));
+    player.getInventory().setSlot(0, ItemStack{1, 64});
+    player.getInventory().setSlot(35, ItemStack{2, 12});
+
+    size_t allocationsBefore = allocationCount;
+    for (auto _ : state) {
+        const PlayerEntity& view = player;
+        std::string_view name = view.getName();
+        benchmark::DoNotOptimize(name.data());
+
+        const Inventory& inventory = view.getInventory();
+        int total = 0;
+        for (const ItemStack& stack : inventory.getSlots()) {
+            total += stack.count;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    size_t allocations = allocationCount - allocationsBefore;
+
+    state.counters["allocations"] = double(allocations);
+    if (allocations != 0) {
+        state.SkipWithError("read access allocated");
+    }
+}
+BENCHMARK(BM_PlayerEntityReadAccess);
+
+// Swapping one item in a 3x3 crafting grid with range(0) recipes loaded; the time should not grow with the count.
+static void BM_CraftingPreviewUpdate(benchmark::State& state) {
+    std::string err;
+    ItemRegistry registry;
+    int itemCount = 64;
+    for (int id = 1; id <= itemCount; ++id) {
+        registry.registerItem(ItemId(id), "item" + std::to_string(id), 64, err);
+    }
+    RecipeBook book;
+    for (int64_t i = 0; book.getCount() < size_t(state.range(0)); ++i) {
+        ItemStack ingredients[3] = {{ItemId(1 + i % itemCount), 1}, {ItemId(1 + (i / itemCount) % itemCount), 2},
+                                    {ItemId(1 + (i / itemCount / itemCount) % itemCount), 1}};
+        book.addRecipe(ingredients, ItemStack{1, 1}, registry, err);
+    }
+
+    Inventory grid(3, 3);
+    grid.setSlot(0, ItemStack{1, 10});
+    grid.setSlot(1, ItemStack{2, 10});
+    grid.setSlot(2, ItemStack{2, 10});
+    CraftingPreview preview;
+    preview.update(grid, ~uint64_t(0), book);
+    grid.clearDirtySlots();
+
+    ItemId next = 3;
+    for (auto _ : state) {
+        grid.setSlot(4, ItemStack{next, 1});
+        next = ItemId(next % itemCount + 1);
+        preview.update(grid, grid.getDirtySlots(), book);
+        grid.clearDirtySlots();
+        benchmark::DoNotOptimize(preview.getRecipeIndex());
+    }
+}
+BENCHMARK(BM_CraftingPreviewUpdate)->RangeMultiplier(8)->Range(8, 32768);
+
+// Resolving range(0) players spread at a constant density (about one neighbour each); the time per player should stay flat.
+static void BM_CollisionResolve(benchmark::State& state) {
+    size_t count = size_t(state.range(0));
+    float side = std::sqrt(float(count)) * 4.0f * PLAYER_RADIUS;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coordinate(0.0f, side);
+    std::vector<EVec> start(count);
+    for (EVec& position : start) {
+        position = {coordinate(rng), coordinate(rng)};
+    }
+
+    CollisionWorld world;
+    world.addObstacle(Aabb{{side * 0.25f, side * 0.25f}, {side * 0.75f, side * 0.3f}});
+    std::vector<EVec> positions = start;
+    world.resolve(positions, PLAYER_RADIUS);
+
+    size_t allocations = allocationCount;
+    size_t contacts = 0;
+    for (auto _ : state) {
+        positions = start;
+        contacts = world.resolve(positions, PLAYER_RADIUS);
+        benchmark::DoNotOptimize(positions.data());
+    }
+    if (allocationCount != allocations) {
+        state.SkipWithError("resolve allocated after warming up");
+    }
+    state.counters["contacts"] = double(contacts);
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_CollisionResolve)->RangeMultiplier(4)->Range(16, 4096);
+
+// Before the thread-local generator, every call built a std::random_device and a std::mt19937.
+static void BM_GenerateRandomPlayerColor(benchmark::State& state) {
+    for (auto _ : state) {
+        PlayerColor color = generateRandomPlayerColor();
+        benchmark::DoNotOptimize(color);
+    }
+}
+BENCHMARK(BM_GenerateRandomPlayerColor);
+
+static void BM_RandomNext(benchmark::State& state) {
+    Random random(42);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(random.next());
+    }
+}
+BENCHMARK(BM_RandomNext);
+
+static void BM_RandomFillFloats(benchmark::State& state) {
+    Random random(42);
+    std::vector<float> values(size_t(state.range(0)));
+    for (auto _ : state) {
+        random.fillFloats(values, -1.0f, 1.0f);
+        benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_RandomFillFloats)->Arg(1024);
@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+
+#include "net_checksum.h"
+#include "server.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/// @brief Fills a server with count players keyed by fake peers.
+/// The peers are never dereferenced by the code under test.
+static void addFakePlayers(GameServer& server, int64_t count) {
+    for (int64_t i = 0; i < count; ++i) {
+        ENetPeer* fakePeer = reinterpret_cast<ENetPeer*>(uintptr_t(i + 1) * alignof(ENetPeer));
+        server.getPlayers()[fakePeer] = PlayerInfo{{float(i), float(i)}, {255, 128, 64, 255}, true};
+    }
+}
+
+static void BM_SnapshotSerialization(benchmark::State& state) {
+    GameServer server;
+    addFakePlayers(server, state.range(0));
+    for (auto _ : state) {
+        ENetPacket* packet = server.CreateSnapshotPacket();
+        benchmark::DoNotOptimize(packet->data);
+        enet_packet_destroy(packet);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SnapshotSerialization)->RangeMultiplier(4)->Range(1, 1024);
+
+static void BM_PacketCreateDestroy(benchmark::State& state) {
+    std::vector<unsigned char> payload(size_t(state.range(0)), 0xAB);
+    for (auto _ : state) {
+        ENetPacket* packet = enet_packet_create(payload.data(), payload.size(), ENET_PACKET_FLAG_RELIABLE);
+        benchmark::DoNotOptimize(packet);
+        enet_packet_destroy(packet);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PacketCreateDestroy)->RangeMultiplier(8)->Range(8, 8 << 10);
+
+// The body of GameServer::BroadcastPlayerStates: one snapshot per connected
+// peer. Packets are destroyed instead of queued on a peer.
+static void BM_ServerBroadcastLoopBody(benchmark::State& state) {
+    GameServer server;
+    addFakePlayers(server, state.range(0));
+    for (auto _ : state) {
+        for (auto& pair : server.getPlayers()) {
+            benchmark::DoNotOptimize(pair.first);
+            ENetPacket* packet = server.CreateSnapshotPacket();
+            enet_packet_destroy(packet);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ServerBroadcastLoopBody)->RangeMultiplier(4)->Range(1, 256);
+
+// A datagram split the way ENet sends it: a header buffer, then command and payload pieces.
+static std::vector<ENetBuffer> makeDatagramBuffers(std::vector<uint8_t>& bytes) {
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = uint8_t(i * 31 + 7);
+    }
+    std::vector<ENetBuffer> buffers;
+    size_t offset = 0;
+    size_t piece = 12;
+    while (offset < bytes.size()) {
+        ENetBuffer buffer;
+        buffer.data = bytes.data() + offset;
+        buffer.dataLength = std::min(piece, bytes.size() - offset);
+        buffers.push_back(buffer);
+        offset += buffer.dataLength;
+        piece = piece == 12 ? 48 : 12;
+    }
+    return buffers;
+}
+
+static void BM_ChecksumEnetCrc32(benchmark::State& state) {
+    std::vector<uint8_t> bytes(size_t(state.range(0)));
+    std::vector<ENetBuffer> buffers = makeDatagramBuffers(bytes);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(enet_crc32(buffers.data(), buffers.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ChecksumEnetCrc32)->RangeMultiplier(4)->Range(64, 1400);
+
+static void BM_ChecksumCrc32c(benchmark::State& state) {
+    std::vector<uint8_t> bytes(size_t(state.range(0)));
+    std::vector<ENetBuffer> buffers = makeDatagramBuffers(bytes);
+    state.SetLabel(net_crc32c_implementation());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(net_crc32c_buffers(buffers.data(), buffers.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ChecksumCrc32c)->RangeMultiplier(4)->Range(64, 1400);
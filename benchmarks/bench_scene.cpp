@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+
+#include "game.h"
+#include "logger.h"
+#include "scene_format.h"
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+/// @brief Writes a JSON scene with count TextEntities, plus its compiled form,
+/// once per entity count.
+/// @return The path of the JSON scene.
+static std::string generateScene(int64_t count) {
+    static std::map<int64_t, std::string> generated;
+    auto it = generated.find(count);
+    if (it != generated.end()) {
+        return it->second;
+    }
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "danaagain_benchmarks";
+    std::filesystem::create_directories(directory);
+    std::filesystem::path jsonPath = directory / ("scene_" + std::to_string(count) + ".json");
+
+    std::string json = "{\"entities\": [";
+    for (int64_t i = 0; i < count; ++i) {
+        json += i == 0 ? "\n" : ",\n";
+        json += "{\"type\": \"TextEntity\", \"text\": \"Entity number " + std::to_string(i) + "\", "
+                "\"position\": {\"x\": " + std::to_string(i % 1920) + ", \"y\": " + std::to_string(i % 1080) + "}, "
+                "\"color\": {\"r\": 255, \"g\": 145, \"b\": 123, \"a\": 255}}";
+    }
+    json += "\n]}\n";
+    std::ofstream(jsonPath, std::ios::binary) << json;
+
+    std::vector<unsigned char> compiled;
+    std::string err;
+    if (compileScene(json.data(), json.size(), compiled, err)) {
+        std::ofstream(std::filesystem::path(jsonPath).replace_extension(SCENE_BINARY_EXTENSION), std::ios::binary)
+            .write(reinterpret_cast<const char*>(compiled.data()), std::streamsize(compiled.size()));
+    }
+
+    return generated[count] = jsonPath.string();
+}
+
+static void BM_LoadJsonScene(benchmark::State& state) {
+    std::string path = generateScene(state.range(0));
+    GameLogger::getInstance().setMinimumLevel(WARNING);
+    for (auto _ : state) {
+        Scene scene = SceneLoader::loadJsonScene(path);
+        benchmark::DoNotOptimize(scene.getAllEntities().data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LoadJsonScene)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_LoadScene(benchmark::State& state) {
+    // loadScene picks the compiled scene generated next to the JSON.
+    std::string path = generateScene(state.range(0));
+    GameLogger::getInstance().setMinimumLevel(WARNING);
+    for (auto _ : state) {
+        Scene scene = SceneLoader::loadScene(path);
+        benchmark::DoNotOptimize(scene.getAllEntities().data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LoadScene)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,505 @@
+// soak: runs the server and N synthetic clients in one process over loopback
+// UDP, drives scripted movement for a fixed duration and reports throughput,
+// tick time and input-to-snapshot latency.
+//
+// Usage: soak [--clients N] [--duration SECONDS] [--port PORT]
+//             [--max-tick-p99-us US] [--max-latency-p99-ms MS] [--min-matched FRACTION]
+//             [--json PATH] [--trace PATH] [--metrics PATH]
+//             [--latency-ms MS] [--jitter-ms MS] [--loss RATE] [--duplicate RATE]
+//             [--reorder RATE] [--bandwidth BYTES_PER_SEC] [--seed SEED]
+//
+// The impairment options simulate a bad network in both directions: every
+// host (server and clients) gets a NetworkImpairment with the same settings.
+// --trace writes the profiling zones of the run as a Chrome trace; it needs a
+// build with ENABLE_PROFILING. --metrics writes the server's metrics in the
+// Prometheus text format at the end of the run.
+//
+// Exits with a non-zero status when a --max-* threshold is exceeded, so it can
+// be used as a performance gate. Latency is only measured for inputs whose
+// result shows up in a snapshot, so the run also fails when any client has
+// fewer than --min-matched (default 0.99) of its inputs matched.
+
+#include "server.h"
+#include "logger.h"
+#include "net_checksum.h"
+#include "net_impairment.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define SOAK_DEFAULT_CLIENTS 16
+#define SOAK_DEFAULT_DURATION_S 10
+#define SOAK_DEFAULT_PORT 6787
+#define SOAK_CONNECT_TIMEOUT_S 5
+#define SOAK_SPREAD_SPACING 250        // Walked circles stay within 80 of the spawn point, so players never come closer than 90.
+#define SOAK_SETTLE_TIMEOUT_S 5
+#define SOAK_DRAIN_TIMEOUT_S 5
+#define SOAK_DEFAULT_MIN_MATCHED 0.99
+
+using SoakClock = std::chrono::steady_clock;
+
+/// @brief A movement delta that was sent and not yet seen in a snapshot.
+struct PendingInput {
+    WorldVec expectedPosition;     // Where the server should put the player after applying this input.
+    SoakClock::time_point sentAt;  // When the input was sent.
+};
+
+/// @brief A synthetic client connected to the in-process server.
+struct SoakClient {
+    ENetHost* host = nullptr;
+    ENetPeer* peer = nullptr;
+    PlayerColor color = {};        // Unique per client, used to find our own entry in snapshots.
+    bool connected = false;
+    bool placed = false;           // The last snapshot had the client at position, before measuring starts.
+    WorldVec position = {WorldFixed(960), WorldFixed(540)};  // Predicted with the server's applyMovement(), so it matches snapshots exactly.
+    std::deque<PendingInput> pending;
+    uint64_t inputsSent = 0;
+    uint64_t inputsMatched = 0;    // Inputs seen applied in a snapshot; only these have a latency sample.
+    std::unique_ptr<NetworkImpairment> impairment;  // Only set when the network is impaired.
+};
+
+struct SoakOptions {
+    int clients = SOAK_DEFAULT_CLIENTS;
+    double duration = SOAK_DEFAULT_DURATION_S;
+    enet_uint16 port = SOAK_DEFAULT_PORT;
+    double maxTickP99Us = 0;       // 0 disables the gate.
+    double maxLatencyP99Ms = 0;    // 0 disables the gate.
+    double minMatched = SOAK_DEFAULT_MIN_MATCHED;
+    std::string jsonPath;
+    std::string tracePath;
+    std::string metricsPath;
+    NetImpairmentConfig impairment = netImpairmentDefaults();
+    bool impaired = false;
+};
+
+static double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    size_t index = size_t(std::ceil(p * double(samples.size()))) - 1;
+    index = std::min(index, samples.size() - 1);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+static bool parseOptions(int argc, char** argv, SoakOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--clients") {
+            options.clients = std::atoi(value);
+        } else if (arg == "--duration") {
+            options.duration = std::atof(value);
+        } else if (arg == "--port") {
+            options.port = enet_uint16(std::atoi(value));
+        } else if (arg == "--max-tick-p99-us") {
+            options.maxTickP99Us = std::atof(value);
+        } else if (arg == "--max-latency-p99-ms") {
+            options.maxLatencyP99Ms = std::atof(value);
+        } else if (arg == "--min-matched") {
+            options.minMatched = std::atof(value);
+        } else if (arg == "--json") {
+            options.jsonPath = value;
+        } else if (arg == "--trace") {
+            options.tracePath = value;
+        } else if (arg == "--metrics") {
+            options.metricsPath = value;
+        } else if (arg == "--latency-ms") {
+            options.impairment.latencyMs = enet_uint32(std::atoi(value));
+            options.impaired = true;
+        } else if (arg == "--jitter-ms") {
+            options.impairment.jitterMs = enet_uint32(std::atoi(value));
+            options.impaired = true;
+        } else if (arg == "--loss") {
+            options.impairment.lossRate = float(std::atof(value));
+            options.impaired = true;
+        } else if (arg == "--duplicate") {
+            options.impairment.duplicateRate = float(std::atof(value));
+            options.impaired = true;
+        } else if (arg == "--reorder") {
+            options.impairment.reorderRate = float(std::atof(value));
+            options.impairment.reorderDelayMs = std::max<enet_uint32>(options.impairment.reorderDelayMs, 20);
+            options.impaired = true;
+        } else if (arg == "--bandwidth") {
+            options.impairment.bandwidthBytesPerSec = enet_uint32(std::atoi(value));
+            options.impaired = true;
+        } else if (arg == "--seed") {
+            options.impairment.seed = std::strtoull(value, nullptr, 10);
+        } else {
+            return false;
+        }
+    }
+    return options.clients > 0 && options.clients <= SERVER_MAX_CLIENTS && options.duration > 0;
+}
+
+/// @brief Services a client host: sends the color on connect and matches snapshots against pending inputs.
+static void serviceClient(SoakClient& client, std::vector<double>& latenciesMs, bool measuring) {
+    if (client.impairment) {
+        client.impairment->pump();
+    }
+
+    ENetEvent event;
+    while (enet_host_service(client.host, &event, 0) > 0) {
+        if (event.type == ENET_EVENT_TYPE_CONNECT) {
+            client.connected = true;
+            ENetPacket* packet = enet_packet_create(&client.color, sizeof(client.color), ENET_PACKET_FLAG_RELIABLE);
+            enet_peer_send(client.peer, 0, packet);
+        } else if (event.type == ENET_EVENT_TYPE_RECEIVE && event.channelID != CHANNEL_SNAPSHOT) {
+            enet_packet_destroy(event.packet);
+        } else if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+            const auto* entries = reinterpret_cast<const std::pair<EVec, PlayerColor>*>(event.packet->data);
+            size_t count = event.packet->dataLength / sizeof(std::pair<EVec, PlayerColor>);
+            for (size_t i = 0; i < count; ++i) {
+                const PlayerColor& color = entries[i].second;
+                if (std::memcmp(&color, &client.color, sizeof(PlayerColor)) != 0) {
+                    continue;
+                }
+
+                // Soak positions stay near the origin, where the snapshot's floats hold WorldVec exactly.
+                WorldVec position = toFixed<WorldFixed>(entries[i].first);
+                if (!measuring) {
+                    // Nothing is sent before measuring; wait for the server to show the client where main() placed it.
+                    client.placed = position == client.position;
+                    break;
+                }
+
+                // Every input up to the one matching the snapshot position has been applied.
+                auto match = std::find_if(client.pending.begin(), client.pending.end(), [&](const PendingInput& input) {
+                    return input.expectedPosition == position;
+                });
+                if (match != client.pending.end()) {
+                    SoakClock::time_point now = SoakClock::now();
+                    for (auto it = client.pending.begin(); it != std::next(match); ++it) {
+                        latenciesMs.push_back(std::chrono::duration<double, std::milli>(now - it->sentAt).count());
+                        client.inputsMatched++;
+                    }
+                    client.pending.erase(client.pending.begin(), std::next(match));
+                }
+                break;
+            }
+            enet_packet_destroy(event.packet);
+        } else if (event.type == ENET_EVENT_TYPE_DISCONNECT) {
+            client.connected = false;
+        }
+    }
+}
+
+/// @brief Sends this tick's scripted movement: each client walks its own circle.
+static void sendMovement(SoakClient& client, int clientIndex, uint64_t tick) {
+    float angle = float(tick) * 0.05f + float(clientIndex);
+    EVec delta = {std::cos(angle) * 2.0f, std::sin(angle) * 2.0f};
+
+    client.position = applyMovement(client.position, toFixed<WorldFixed>(delta));
+    client.pending.push_back(PendingInput{client.position, SoakClock::now()});
+    client.inputsSent++;
+
+    ENetPacket* packet = enet_packet_create(&delta, sizeof(delta), ENET_PACKET_FLAG_RELIABLE);
+    enet_peer_send(client.peer, 0, packet);
+    enet_host_flush(client.host);
+}
+
+int main(int argc, char** argv) {
+    SoakOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "Usage: %s [--clients N (1-%d)] [--duration SECONDS] [--port PORT] "
+                             "[--max-tick-p99-us US] [--max-latency-p99-ms MS] [--min-matched FRACTION] "
+                             "[--json PATH] [--trace PATH] [--metrics PATH] "
+                             "[--latency-ms MS] [--jitter-ms MS] [--loss RATE] [--duplicate RATE] "
+                             "[--reorder RATE] [--bandwidth BYTES_PER_SEC] [--seed SEED]\n",
+                     argv[0], SERVER_MAX_CLIENTS);
+        return EXIT_FAILURE;
+    }
+
+    GameLogger::getInstance().setMinimumLevel(WARNING);
+
+    GameServer server;
+    if (!server.Start(options.port)) {
+        return EXIT_FAILURE;
+    }
+
+    // Every synthetic client connects from 127.0.0.1 at the same moment.
+    AdmissionConfig admission = admissionDefaults();
+    admission.maxPeersPerAddress = SERVER_MAX_CLIENTS;
+    admission.connectBurst = float(SERVER_MAX_CLIENTS) * 4.0f;
+    admission.datagramRate = admission.datagramBurst = 1e6f;
+    server.SetAdmissionConfig(admission);
+    if (!server.Open()) {
+        return EXIT_FAILURE;
+    }
+
+    NetworkImpairment serverImpairment(options.impairment);
+    if (options.impaired) {
+        serverImpairment.attach(server.getHost());
+    }
+
+    ENetAddress serverAddress;
+    enet_address_set_host(&serverAddress, "127.0.0.1");
+    serverAddress.port = options.port;
+
+    std::vector<SoakClient> clients(size_t(options.clients));
+    for (int i = 0; i < options.clients; ++i) {
+        SoakClient& client = clients[size_t(i)];
+        client.color = PlayerColor{(unsigned char)(i & 0xFF), (unsigned char)((i >> 8) & 0xFF), 200, 255};
+        client.host = enet_host_create(NULL, 1, SERVER_CHANNEL_COUNT, 0, 0);
+        if (client.host != nullptr) {
+            net_enable_checksum(client.host);
+        }
+        client.peer = client.host != nullptr ? enet_host_connect(client.host, &serverAddress, SERVER_CHANNEL_COUNT, 0) : nullptr;
+        if (client.peer == nullptr) {
+            std::fprintf(stderr, "Failed to create synthetic client %d\n", i);
+            return EXIT_FAILURE;
+        }
+        if (options.impaired) {
+            // Each client gets its own stream of random decisions, still derived from the one seed.
+            NetImpairmentConfig config = options.impairment;
+            config.seed += uint64_t(i) + 1;
+            client.impairment = std::make_unique<NetworkImpairment>(config);
+            client.impairment->attach(client.host);
+        }
+    }
+
+    std::vector<double> tickTimesUs;
+    std::vector<double> latenciesMs;
+
+    // Connect and join every client before measuring.
+    SoakClock::time_point connectDeadline = SoakClock::now() + std::chrono::seconds(SOAK_CONNECT_TIMEOUT_S);
+    while (true) {
+        serverImpairment.pump();
+        server.Tick();
+        size_t connected = 0;
+        for (SoakClient& client : clients) {
+            serviceClient(client, latenciesMs, false);
+            connected += client.connected ? 1 : 0;
+        }
+        // Placing the players below finds them by the color they joined with.
+        size_t joined = size_t(std::count_if(server.getPlayers().begin(), server.getPlayers().end(), [](const auto& pair) {
+            return pair.second.id != INVALID_PLAYER_ID;
+        }));
+        if (connected == clients.size() && joined == clients.size()) {
+            break;
+        }
+        if (SoakClock::now() > connectDeadline) {
+            std::fprintf(stderr, "Only %zu of %zu clients connected\n", connected, clients.size());
+            return EXIT_FAILURE;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Players spawn on top of each other. Put every one on its own spot of a grid instead, so
+    // collisions never change the positions the clients predict.
+    int gridColumns = int(std::ceil(std::sqrt(double(clients.size()))));
+    for (auto& [peer, playerInfo] : server.getPlayers()) {
+        auto client = std::find_if(clients.begin(), clients.end(), [&](const SoakClient& candidate) {
+            return std::memcmp(&candidate.color, &playerInfo.color, sizeof(PlayerColor)) == 0;
+        });
+        if (client == clients.end()) {
+            continue;
+        }
+        int i = int(client - clients.begin());
+        playerInfo.position = {WorldFixed(960 + i % gridColumns * SOAK_SPREAD_SPACING), WorldFixed(540 + i / gridColumns * SOAK_SPREAD_SPACING)};
+        client->position = playerInfo.position;
+        client->placed = false;
+    }
+
+    // Measure only once every client has seen itself there, or its first inputs would never match.
+    SoakClock::time_point settleDeadline = SoakClock::now() + std::chrono::seconds(SOAK_SETTLE_TIMEOUT_S);
+    while (true) {
+        serverImpairment.pump();
+        server.Tick();
+        size_t placed = 0;
+        for (SoakClient& client : clients) {
+            serviceClient(client, latenciesMs, false);
+            placed += client.placed ? 1 : 0;
+        }
+        if (placed == clients.size()) {
+            break;
+        }
+        if (SoakClock::now() > settleDeadline) {
+            std::fprintf(stderr, "Only %zu of %zu clients reached their spawn points\n", placed, clients.size());
+            return EXIT_FAILURE;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_MS));
+    }
+
+    ENetHost* host = server.getHost();
+    MetricsRegistry& metrics = server.getMetrics();
+    Counter& sentPackets = metrics.counter("server_sent_packets_total", "");
+    Counter& sentBytes = metrics.counter("server_sent_bytes_total", "");
+    Counter& receivedPackets = metrics.counter("server_received_packets_total", "");
+    Counter& receivedBytes = metrics.counter("server_received_bytes_total", "");
+    uint64_t sentPacketsAtStart = sentPackets.get();
+    uint64_t sentBytesAtStart = sentBytes.get();
+    uint64_t receivedPacketsAtStart = receivedPackets.get();
+    uint64_t receivedBytesAtStart = receivedBytes.get();
+
+    SoakClock::time_point start = SoakClock::now();
+    SoakClock::time_point end = start + std::chrono::duration_cast<SoakClock::duration>(std::chrono::duration<double>(options.duration));
+    SoakClock::time_point nextTick = start;
+    uint64_t tick = 0;
+
+    while (SoakClock::now() < end) {
+        for (size_t i = 0; i < clients.size(); ++i) {
+            sendMovement(clients[i], int(i), tick);
+        }
+
+        SoakClock::time_point tickStart = SoakClock::now();
+        serverImpairment.pump();
+        server.Tick();
+        enet_host_flush(host);
+        tickTimesUs.push_back(std::chrono::duration<double, std::micro>(SoakClock::now() - tickStart).count());
+
+        // Keep servicing the clients until the next tick is due.
+        nextTick += std::chrono::milliseconds(SLEEP_MS);
+        do {
+            for (SoakClient& client : clients) {
+                serviceClient(client, latenciesMs, true);
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        } while (SoakClock::now() < nextTick);
+        ++tick;
+    }
+
+    double elapsed = std::chrono::duration<double>(SoakClock::now() - start).count();
+    double sentPacketsPerSec = double(sentPackets.get() - sentPacketsAtStart) / elapsed;
+    double sentBytesPerSec = double(sentBytes.get() - sentBytesAtStart) / elapsed;
+    double receivedPacketsPerSec = double(receivedPackets.get() - receivedPacketsAtStart) / elapsed;
+    double receivedBytesPerSec = double(receivedBytes.get() - receivedBytesAtStart) / elapsed;
+
+    // Let the inputs still in flight come back, so they are not counted as unmatched. The
+    // traffic and tick time above stop at the end of the run.
+    SoakClock::time_point drainDeadline = SoakClock::now() + std::chrono::seconds(SOAK_DRAIN_TIMEOUT_S);
+    auto anyPending = [&] {
+        return std::any_of(clients.begin(), clients.end(), [](const SoakClient& client) { return !client.pending.empty(); });
+    };
+    while (anyPending() && SoakClock::now() < drainDeadline) {
+        serverImpairment.pump();
+        server.Tick();
+        for (SoakClient& client : clients) {
+            serviceClient(client, latenciesMs, true);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_MS));
+    }
+
+    uint64_t inputsSent = 0;
+    uint64_t inputsMatched = 0;
+    double worstMatched = 1.0;
+    size_t worstClient = 0;
+    for (size_t i = 0; i < clients.size(); ++i) {
+        inputsSent += clients[i].inputsSent;
+        inputsMatched += clients[i].inputsMatched;
+        double matched = clients[i].inputsSent > 0 ? double(clients[i].inputsMatched) / double(clients[i].inputsSent) : 1.0;
+        if (matched < worstMatched) {
+            worstMatched = matched;
+            worstClient = i;
+        }
+    }
+    double tickP50 = percentile(tickTimesUs, 0.50);
+    double tickP99 = percentile(tickTimesUs, 0.99);
+    double tickP999 = percentile(tickTimesUs, 0.999);
+    double latencyP50 = percentile(latenciesMs, 0.50);
+    double latencyP99 = percentile(latenciesMs, 0.99);
+    double latencyP999 = percentile(latenciesMs, 0.999);
+
+    std::printf("clients: %d, duration: %.1fs, ticks: %llu, latency samples: %zu\n",
+                options.clients, elapsed, (unsigned long long)tick, latenciesMs.size());
+    std::printf("server sent:     %10.0f packets/s %12.0f bytes/s\n", sentPacketsPerSec, sentBytesPerSec);
+    std::printf("server received: %10.0f packets/s %12.0f bytes/s\n", receivedPacketsPerSec, receivedBytesPerSec);
+    std::printf("tick time (us):  p50 %8.1f  p99 %8.1f  p999 %8.1f\n", tickP50, tickP99, tickP999);
+    std::printf("latency (ms):    p50 %8.2f  p99 %8.2f  p999 %8.2f\n", latencyP50, latencyP99, latencyP999);
+    std::printf("inputs:          %llu sent, %llu matched, worst client %zu at %.1f%%\n",
+                (unsigned long long)inputsSent, (unsigned long long)inputsMatched, worstClient, worstMatched * 100.0);
+    for (size_t i = 0; i < clients.size(); ++i) {
+        std::printf("  client %3zu: %6llu sent %6llu matched\n", i,
+                    (unsigned long long)clients[i].inputsSent, (unsigned long long)clients[i].inputsMatched);
+    }
+
+    if (!options.jsonPath.empty()) {
+        std::string perClient;
+        for (const SoakClient& client : clients) {
+            perClient += (perClient.empty() ? "" : ", ") + std::string("{\"sent\": ") + std::to_string(client.inputsSent) +
+                         ", \"matched\": " + std::to_string(client.inputsMatched) + "}";
+        }
+        FILE* file = std::fopen(options.jsonPath.c_str(), "w");
+        if (file == nullptr) {
+            std::fprintf(stderr, "Failed to write %s\n", options.jsonPath.c_str());
+        } else {
+            std::fprintf(file,
+                "{\"clients\": %d, \"duration_s\": %.3f, \"ticks\": %llu,\n"
+                " \"sent_packets_per_s\": %.1f, \"sent_bytes_per_s\": %.1f,\n"
+                " \"received_packets_per_s\": %.1f, \"received_bytes_per_s\": %.1f,\n"
+                " \"tick_us\": {\"p50\": %.2f, \"p99\": %.2f, \"p999\": %.2f},\n"
+                " \"latency_ms\": {\"p50\": %.3f, \"p99\": %.3f, \"p999\": %.3f, \"samples\": %zu},\n"
+                " \"inputs\": {\"sent\": %llu, \"matched\": %llu, \"clients\": [%s]}}\n",
+                options.clients, elapsed, (unsigned long long)tick,
+                sentPacketsPerSec, sentBytesPerSec, receivedPacketsPerSec, receivedBytesPerSec,
+                tickP50, tickP99, tickP999, latencyP50, latencyP99, latencyP999, latenciesMs.size(),
+                (unsigned long long)inputsSent, (unsigned long long)inputsMatched, perClient.c_str());
+            std::fclose(file);
+        }
+    }
+
+    if (!options.tracePath.empty() && !Profiler::getInstance().writeChromeTrace(options.tracePath.c_str())) {
+        std::fprintf(stderr, "Failed to write %s\n", options.tracePath.c_str());
+    }
+
+    if (!options.metricsPath.empty() && !metrics.writeToFile(options.metricsPath)) {
+        std::fprintf(stderr, "Failed to write %s\n", options.metricsPath.c_str());
+    }
+
+    if (options.impaired) {
+        const NetImpairmentStats& stats = serverImpairment.getStats();
+        std::printf("server impairment: %llu received, %llu lost, %llu overflowed, %llu duplicated, %llu reordered\n",
+                    (unsigned long long)stats.received, (unsigned long long)stats.lost,
+                    (unsigned long long)stats.overflowed, (unsigned long long)stats.duplicated,
+                    (unsigned long long)stats.reordered);
+    }
+
+    for (SoakClient& client : clients) {
+        enet_peer_disconnect_now(client.peer, 0);
+        client.impairment.reset();
+        enet_host_destroy(client.host);
+    }
+    serverImpairment.detach();
+    server.Stop();
+
+    int status = EXIT_SUCCESS;
+    if (options.maxTickP99Us > 0 && tickP99 > options.maxTickP99Us) {
+        std::fprintf(stderr, "FAIL: tick p99 %.1fus exceeds %.1fus\n", tickP99, options.maxTickP99Us);
+        status = EXIT_FAILURE;
+    }
+    if (latenciesMs.empty()) {
+        std::fprintf(stderr, "FAIL: no latency samples, no client saw any of its inputs applied in a snapshot\n");
+        status = EXIT_FAILURE;
+    } else if (options.maxLatencyP99Ms > 0 && latencyP99 > options.maxLatencyP99Ms) {
+        std::fprintf(stderr, "FAIL: latency p99 %.2fms exceeds %.2fms\n", latencyP99, options.maxLatencyP99Ms);
+        status = EXIT_FAILURE;
+    }
+    // The percentiles only cover matched inputs; a client whose inputs go unmatched would silently drop out of them.
+    for (size_t i = 0; i < clients.size(); ++i) {
+        const SoakClient& client = clients[i];
+        double matched = client.inputsSent > 0 ? double(client.inputsMatched) / double(client.inputsSent) : 1.0;
+        if (client.inputsSent > 0 && client.inputsMatched == 0) {
+            std::fprintf(stderr, "FAIL: client %zu had none of its %llu inputs matched by a snapshot\n",
+                         i, (unsigned long long)client.inputsSent);
+            status = EXIT_FAILURE;
+        } else if (matched < options.minMatched) {
+            std::fprintf(stderr, "FAIL: client %zu had %.1f%% of its inputs matched, below %.1f%%\n",
+                         i, matched * 100.0, options.minMatched * 100.0);
+            status = EXIT_FAILURE;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,258 @@
+#include <asset_manager.h>
+
+#include <game.h>
+#include <logger.h>
+#include <scene_format.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#ifdef ASSET_HOT_RELOAD
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+AssetManager::AssetManager() : stopping(false) {
+#ifdef ASSET_HOT_RELOAD
+    watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watchFd < 0) {
+        GAME_LOG_WARNING("Failed to initialize inotify, asset hot reload disabled.");
+    }
+#endif
+    worker = std::thread(&AssetManager::workerLoop, this);
+}
+
+AssetManager::~AssetManager() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobCondition.notify_all();
+    worker.join();
+
+    // Images that were decoded but never uploaded.
+    for (TextureJob& job : decodedJobs) {
+        UnloadImage(job.image);
+    }
+
+#ifdef ASSET_HOT_RELOAD
+    if (watchFd >= 0) {
+        close(watchFd);
+    }
+#endif
+}
+
+std::string AssetManager::normalizePath(const std::string& path) {
+    return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+AssetHandle<Texture2D> AssetManager::getTexture(const std::string& path) {
+    std::string key = normalizePath(path);
+    auto it = textures.find(key);
+    if (it != textures.end()) {
+        return AssetHandle<Texture2D>(it->second);
+    }
+
+    auto entry = std::make_shared<AssetEntry<Texture2D>>();
+    entry->path = key;
+    textures.emplace(key, entry);
+    queueTexture(entry);
+#ifdef ASSET_HOT_RELOAD
+    watchDirectoryOf(key);
+#endif
+    return AssetHandle<Texture2D>(entry);
+}
+
+AssetHandle<Font> AssetManager::getFont(const std::string& path) {
+    std::string key = normalizePath(path);
+    auto it = fonts.find(key);
+    if (it != fonts.end()) {
+        return AssetHandle<Font>(it->second);
+    }
+
+    auto entry = std::make_shared<AssetEntry<Font>>();
+    entry->path = key;
+    entry->asset = LoadFont(key.c_str());
+    entry->ready = true;
+    entry->version = 1;
+    fonts.emplace(key, entry);
+#ifdef ASSET_HOT_RELOAD
+    watchDirectoryOf(key);
+#endif
+    return AssetHandle<Font>(entry);
+}
+
+AssetHandle<SceneAsset> AssetManager::getScene(const std::string& path) {
+    std::string key = normalizePath(path);
+    auto it = scenes.find(key);
+    if (it != scenes.end()) {
+        return AssetHandle<SceneAsset>(it->second);
+    }
+
+    auto entry = std::make_shared<AssetEntry<SceneAsset>>();
+    entry->path = key;
+    loadSceneAsset(*entry);
+    scenes.emplace(key, entry);
+#ifdef ASSET_HOT_RELOAD
+    watchDirectoryOf(key);
+#endif
+    return AssetHandle<SceneAsset>(entry);
+}
+
+bool AssetManager::loadSceneAsset(AssetEntry<SceneAsset>& entry) {
+    std::string resolvedPath = SceneLoader::resolveScenePath(entry.path);
+    std::ifstream file(resolvedPath, std::ios::binary);
+    if (!file.is_open()) {
+        GAME_LOG_ERROR("Failed to open scene file: %s", resolvedPath.c_str());
+        return false;
+    }
+
+    entry.asset.bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    entry.ready = true;
+    entry.version++;
+    return true;
+}
+
+void AssetManager::queueTexture(const std::shared_ptr<AssetEntry<Texture2D>>& entry) {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        pendingJobs.push_back(TextureJob{entry, Image{}});
+    }
+    jobCondition.notify_one();
+}
+
+void AssetManager::workerLoop() {
+    while (true) {
+        TextureJob job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobCondition.wait(lock, [this] { return stopping || !pendingJobs.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = std::move(pendingJobs.front());
+            pendingJobs.pop_front();
+        }
+
+        // Reading and decoding the file is CPU only, the GPU upload happens in update().
+        job.image = LoadImage(job.entry->path.c_str());
+
+        std::lock_guard<std::mutex> lock(jobMutex);
+        decodedJobs.push_back(std::move(job));
+    }
+}
+
+void AssetManager::update() {
+    std::vector<TextureJob> decoded;
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        decoded.swap(decodedJobs);
+    }
+
+    for (TextureJob& job : decoded) {
+        AssetEntry<Texture2D>& entry = *job.entry;
+        if (job.image.data == nullptr) {
+            GAME_LOG_ERROR("Failed to load texture: %s", entry.path.c_str());
+            continue;
+        }
+
+        // On a reload the previous texture stays in use until the new one is ready.
+        if (entry.ready) {
+            UnloadTexture(entry.asset);
+        }
+        entry.asset = LoadTextureFromImage(job.image);
+        entry.ready = true;
+        entry.version++;
+        UnloadImage(job.image);
+    }
+
+#ifdef ASSET_HOT_RELOAD
+    pollFileChanges();
+#endif
+}
+
+size_t AssetManager::collectUnused() {
+    // Entries referenced only by the cache itself have no handles left. Pending
+    // texture jobs hold a reference too, so in-flight loads are never dropped.
+    size_t released = 0;
+    released += std::erase_if(textures, [](const auto& pair) { return pair.second.use_count() == 1; });
+    released += std::erase_if(fonts, [](const auto& pair) { return pair.second.use_count() == 1; });
+    released += std::erase_if(scenes, [](const auto& pair) { return pair.second.use_count() == 1; });
+    return released;
+}
+
+void AssetManager::reload(const std::string& path) {
+    auto texture = textures.find(path);
+    if (texture != textures.end()) {
+        GAME_LOG_INFO("Reloading texture: %s", path.c_str());
+        queueTexture(texture->second);
+    }
+
+    auto font = fonts.find(path);
+    if (font != fonts.end()) {
+        GAME_LOG_INFO("Reloading font: %s", path.c_str());
+        AssetEntry<Font>& entry = *font->second;
+        UnloadFont(entry.asset);
+        entry.asset = LoadFont(path.c_str());
+        entry.version++;
+    }
+
+    // Scenes are keyed by their JSON path but may be loaded from the compiled sibling.
+    std::string scenePath = path;
+    if (std::filesystem::path(path).extension() == SCENE_BINARY_EXTENSION) {
+        scenePath = std::filesystem::path(path).replace_extension(".json").generic_string();
+    }
+    auto scene = scenes.find(scenePath);
+    if (scene != scenes.end()) {
+        GAME_LOG_INFO("Reloading scene: %s", scenePath.c_str());
+        loadSceneAsset(*scene->second);
+    }
+}
+
+#ifdef ASSET_HOT_RELOAD
+
+void AssetManager::watchDirectoryOf(const std::string& path) {
+    if (watchFd < 0) {
+        return;
+    }
+
+    std::string directory = std::filesystem::path(path).parent_path().generic_string();
+    if (directory.empty()) {
+        directory = ".";
+    }
+
+    // Editors usually save by writing a temporary file and renaming it over the
+    // original, so watch the directory rather than the file itself.
+    int wd = inotify_add_watch(watchFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0) {
+        GAME_LOG_WARNING("Failed to watch asset directory: %s", directory.c_str());
+        return;
+    }
+    watchedDirectories[wd] = directory;
+}
+
+void AssetManager::pollFileChanges() {
+    if (watchFd < 0) {
+        return;
+    }
+
+    alignas(struct inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t length = read(watchFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            return;
+        }
+
+        for (char* ptr = buffer; ptr < buffer + length;) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+            auto directory = watchedDirectories.find(event->wd);
+            if (directory != watchedDirectories.end() && event->len > 0) {
+                reload(normalizePath(directory->second + "/" + event->name));
+            }
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+#endif
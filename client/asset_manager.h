@@ -0,0 +1,156 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/// @brief The raw contents of a scene file, kept in memory so the scene can be
+/// instantiated again without touching the disk.
+/// @see SceneLoader::loadSceneFromMemory
+struct SceneAsset {
+    std::vector<unsigned char> bytes;  // Contents of the compiled or JSON scene file.
+};
+
+/// @brief Releases the GPU/CPU resources held by a loaded asset.
+inline void unloadAsset(Texture2D& texture) { UnloadTexture(texture); }
+inline void unloadAsset(Font& font) { UnloadFont(font); }
+inline void unloadAsset(SceneAsset&) {}
+
+/// @brief A cached asset shared by every handle to the same path.
+/// @tparam T The asset type (Texture2D, Font or SceneAsset).
+template <typename T>
+struct AssetEntry {
+    std::string path;      // Normalized path, also the cache key.
+    T asset{};             // The loaded asset, only valid when ready is true.
+    bool ready = false;    // Whether asset holds a loaded value.
+    uint32_t version = 0;  // Incremented every time the asset is (re)loaded.
+
+    AssetEntry() = default;
+    AssetEntry(const AssetEntry&) = delete;
+    AssetEntry& operator=(const AssetEntry&) = delete;
+
+    ~AssetEntry() {
+        if (ready) {
+            unloadAsset(asset);
+        }
+    }
+};
+
+/// @brief A reference counted handle to a cached asset.
+/// Handles stay valid across hot reloads; compare getVersion() to notice a reload.
+/// @tparam T The asset type (Texture2D, Font or SceneAsset).
+template <typename T>
+class AssetHandle {
+private:
+    std::shared_ptr<AssetEntry<T>> entry;
+
+public:
+    AssetHandle() = default;
+    explicit AssetHandle(std::shared_ptr<AssetEntry<T>> entry) : entry(std::move(entry)) {}
+
+    /// @brief Checks whether the asset finished loading.
+    /// @return True if get() returns a loaded asset.
+    bool isReady() const { return entry && entry->ready; }
+
+    /// @brief Gets the loaded asset.
+    /// @return A pointer to the asset, or nullptr while it is still loading.
+    const T* get() const { return isReady() ? &entry->asset : nullptr; }
+
+    /// @brief Gets how many times the asset has been loaded.
+    /// @return 0 while loading, then 1, and one more for each hot reload.
+    uint32_t getVersion() const { return entry ? entry->version : 0; }
+
+    /// @brief Gets the path the asset was loaded from.
+    /// @return The normalized path, or an empty string for an empty handle.
+    const std::string& getPath() const {
+        static const std::string empty;
+        return entry ? entry->path : empty;
+    }
+
+    explicit operator bool() const { return entry != nullptr; }
+};
+
+/// @brief Loads and caches textures, fonts and scenes by path.
+/// Each path is read from disk once; later requests share the cached asset.
+/// Texture files are read and decoded on a background thread and uploaded to
+/// the GPU in update(), which must be called on the main (GL) thread each frame.
+/// In builds with ASSET_HOT_RELOAD defined (Debug builds on Linux), files that
+/// change on disk are reloaded in place.
+/// @warning Must be destroyed before the window is closed.
+class AssetManager {
+private:
+    /// @brief A texture file that is waiting to be decoded, or has been decoded.
+    struct TextureJob {
+        std::shared_ptr<AssetEntry<Texture2D>> entry;
+        Image image;
+    };
+
+    std::unordered_map<std::string, std::shared_ptr<AssetEntry<Texture2D>>> textures;
+    std::unordered_map<std::string, std::shared_ptr<AssetEntry<Font>>> fonts;
+    std::unordered_map<std::string, std::shared_ptr<AssetEntry<SceneAsset>>> scenes;
+
+    std::mutex jobMutex;                    // Guards pendingJobs, decodedJobs and stopping.
+    std::condition_variable jobCondition;   // Signalled when a job is queued or on shutdown.
+    std::deque<TextureJob> pendingJobs;     // Textures waiting for the worker.
+    std::vector<TextureJob> decodedJobs;    // Decoded images waiting for the GPU upload.
+    bool stopping;
+    std::thread worker;
+
+#ifdef ASSET_HOT_RELOAD
+    int watchFd;                                           // inotify instance, -1 if unavailable.
+    std::unordered_map<int, std::string> watchedDirectories;  // Watch descriptor -> directory.
+
+    void watchDirectoryOf(const std::string& path);
+    void pollFileChanges();
+#endif
+
+    void workerLoop();
+    void queueTexture(const std::shared_ptr<AssetEntry<Texture2D>>& entry);
+    void reload(const std::string& path);
+    static bool loadSceneAsset(AssetEntry<SceneAsset>& entry);
+
+public:
+    /// @brief Normalizes a path so equivalent spellings share a cache entry.
+    /// @param path The path to normalize.
+    /// @return The normalized path.
+    static std::string normalizePath(const std::string& path);
+
+    /// @brief Gets a texture, starting a background load on first use.
+    /// @param path The path of the image file.
+    /// @return A handle that becomes ready after a later update().
+    AssetHandle<Texture2D> getTexture(const std::string& path);
+
+    /// @brief Gets a font, loading it on first use.
+    /// @note Fonts are loaded synchronously since raylib uploads them while loading.
+    /// @param path The path of the font file.
+    /// @return A handle to the font.
+    AssetHandle<Font> getFont(const std::string& path);
+
+    /// @brief Gets the contents of a scene, reading it on first use.
+    /// The compiled form is cached instead when SceneLoader would prefer it.
+    /// @param path The path of the JSON scene.
+    /// @return A handle to the scene contents.
+    AssetHandle<SceneAsset> getScene(const std::string& path);
+
+    /// @brief Uploads decoded textures and applies pending hot reloads.
+    /// @note Must be called on the main thread.
+    void update();
+
+    /// @brief Drops cached assets that no handle refers to anymore.
+    /// @return The number of assets released.
+    size_t collectUnused();
+
+    AssetManager();
+    ~AssetManager();
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+};
@@ -4,9 +4,12 @@
 #include <algorithm>
 
 #include "picojson.h"
+#include "scene_parse.h"
+#include <mapped_file.h>
+#include <profiler.h>
+#include <scene_format.h>
+#include <filesystem>
 #include <fstream>
-#include <sstream>
-#include <iostream>
 
 
 GameWindow::GameWindow() noexcept {
@@ -24,54 +27,98 @@ GameWindow::~GameWindow() noexcept {
 }
 
 
-Scene SceneLoader::loadScene(const std::string& filePath) {
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open scene file: " << filePath << std::endl;
-        return Scene();  // Return an empty scene on failure
+std::string SceneLoader::resolveScenePath(const std::string& filePath) {
+    std::filesystem::path binaryPath = std::filesystem::path(filePath).replace_extension(SCENE_BINARY_EXTENSION);
+
+    std::error_code ec;
+    std::filesystem::file_time_type binaryTime = std::filesystem::last_write_time(binaryPath, ec);
+    if (ec) {
+        return filePath;
     }
-    std::cerr << "Loading scene file... " << filePath << std::endl;
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    file.close();
+    std::filesystem::file_time_type jsonTime = std::filesystem::last_write_time(filePath, ec);
+    if (!ec && binaryTime < jsonTime) {
+        GAME_LOG_WARNING("Compiled scene is older than its source, ignoring: %s", binaryPath.string().c_str());
+        return filePath;
+    }
 
-    picojson::value v;
-    std::string err = picojson::parse(v, buffer.str());
-    if (!err.empty()) {
-        std::cerr << "JSON parse error: " << err << std::endl;
-        return Scene();  // Return an empty scene on parse error
+    return binaryPath.string();
+}
+
+Scene SceneLoader::loadScene(const std::string& filePath) {
+    std::string resolvedPath = resolveScenePath(filePath);
+    if (resolvedPath != filePath) {
+        Scene scene;
+        if (loadBinaryScene(resolvedPath, scene)) {
+            return scene;
+        }
+        GAME_LOG_WARNING("Invalid compiled scene, falling back to JSON: %s", resolvedPath.c_str());
     }
 
+    return loadJsonScene(filePath);
+}
+
+Scene SceneLoader::loadSceneFromMemory(const unsigned char* data, size_t size) {
+    PROFILE_FUNCTION();
     Scene scene;
+    if (loadBinaryScene(data, size, scene)) {
+        return scene;
+    }
+    return parseJsonScene(reinterpret_cast<const char*>(data), size);
+}
 
-    // Parse the scene object
-    picojson::object& sceneObj = v.get<picojson::object>();
-
-    // Parse entities
-    picojson::array& entities = sceneObj["entities"].get<picojson::array>();
-    for (picojson::array::iterator it = entities.begin(); it != entities.end(); ++it) {
-        picojson::object& entityObj = it->get<picojson::object>();
-        std::string type = entityObj["type"].get<std::string>();
-
-        if (type == "TextEntity") {
-            std::cerr << "Loading TextEntity..." << std::endl;
-            std::string text = entityObj["text"].get<std::string>();
-            picojson::object& positionObj = entityObj["position"].get<picojson::object>();
-            EVec position = { float(positionObj["x"].get<double>()), float(positionObj["y"].get<double>()) };
-
-            picojson::object& colorObj = entityObj["color"].get<picojson::object>();
-            Color color = { uint8_t(colorObj["r"].get<double>()), uint8_t(colorObj["g"].get<double>()),
-                                  uint8_t(colorObj["b"].get<double>()), uint8_t(colorObj["a"].get<double>()) };
-
-            auto entity = std::make_unique<TextEntity>(text, position, Color{color.r, color.g, color.b, color.a});
-            
-            std::cerr << "Added entity: " << text  << std::endl;
-            scene.addEntity(std::move(entity));
-        } else {
-            std::cerr << "Could not locate type: '" << type << "'" << std::endl;
-        }
-        // Add more entity types as needed
+bool SceneLoader::loadBinaryScene(const std::string& filePath, Scene& scene) {
+    MappedFile file;
+    if (!file.open(filePath)) {
+        GAME_LOG_ERROR("Failed to map compiled scene file: %s", filePath.c_str());
+        return false;
+    }
+    GAME_LOG_DEBUG("Loading compiled scene file... %s", filePath.c_str());
+
+    return loadBinaryScene(file.data(), file.size(), scene);
+}
+
+bool SceneLoader::loadBinaryScene(const unsigned char* data, size_t size, Scene& scene) {
+    PROFILE_FUNCTION();
+    const SceneBinaryHeader* header = validateSceneBinary(data, size);
+    if (header == nullptr) {
+        return false;
+    }
+
+    const SceneBinaryTextEntity* textEntities = getSceneBinaryTextEntities(data, header);
+    const char* strings = getSceneBinaryStrings(data, header);
+    for (uint32_t i = 0; i < header->textEntityCount; ++i) {
+        const SceneBinaryTextEntity& record = textEntities[i];
+        scene.addEntity(std::make_unique<TextEntity>(
+            std::string(strings + record.textOffset, record.textLength),
+            EVec{record.x, record.y},
+            Color{record.r, record.g, record.b, record.a}));
+    }
+
+    return true;
+}
+
+Scene SceneLoader::loadJsonScene(const std::string& filePath) {
+    MappedFile file;
+    if (!file.open(filePath)) {
+        GAME_LOG_ERROR("Failed to open scene file: %s", filePath.c_str());
+        return Scene();  // Return an empty scene on failure
+    }
+    GAME_LOG_DEBUG("Loading scene file... %s", filePath.c_str());
+
+    return parseJsonScene(reinterpret_cast<const char*>(file.data()), file.size());
+}
+
+Scene SceneLoader::parseJsonScene(const char* data, size_t size) {
+    PROFILE_FUNCTION();
+    // Stream entities straight out of the buffer, see scene_parse.h.
+    Scene scene;
+    SceneParseContext ctx(&scene);
+    std::string err;
+    picojson::_parse(ctx, data, data + size, &err);
+    if (!err.empty()) {
+        GAME_LOG_ERROR("JSON parse error: %s", err.c_str());
+        return Scene();  // Return an empty scene on parse error
     }
 
     return scene;
@@ -110,7 +157,7 @@ void SceneLoader::saveScene(const Scene& scene, const std::string& filePath) {
     // Write JSON to file
     std::ofstream file(filePath);
     if (!file.is_open()) {
-        std::cerr << "Failed to open scene file for writing: " << filePath << std::endl;
+        GAME_LOG_ERROR("Failed to open scene file for writing: %s", filePath.c_str());
         return;
     }
 
@@ -128,8 +175,7 @@ void PlayerEntityObject::Update() {
 }
 
 void PlayerEntityObject::Render() {
-    // Implement render logic here
-    DrawCircle(pos.x, pos.y, 20, { color.r, color.g, color.b, color.a });
+    Game::getInstance().drawPlayer(pos, color);
 }
 
 Scene::Scene() {
@@ -163,52 +209,31 @@ Scene& SceneManager::getScene() {
 }
 
 
-LogLevel GameLogger::getLogLevel() {
-    return logLevel;
-}
-
-void GameLogger::setLogLevel(LogLevel level) {
-    logLevel = level;
-}
-
-void GameLogger::Log(std::string msg) {
-    Log(logLevel, msg);
-}
-
-void GameLogger::Log(LogLevel level, std::string msg) {
-    switch (level) {
-        case DEBUG: 
-            TraceLog(LOG_DEBUG, msg.c_str());
-            break;
-        case WARNING:
-            TraceLog(LOG_WARNING, msg.c_str());
-            break;
-        case INFO:
-            TraceLog(LOG_INFO, msg.c_str());
-            break;
-        case ERROR:
-            TraceLog(LOG_ERROR, msg.c_str());
-            break;
-        case CRITICAL:
-            TraceLog(LOG_FATAL, msg.c_str());
-            break;
-    }
-}
-
-
-Game::Game() : gameWindow(), gameState(), sceneManager(), playerState(), gameLogger(),
+Game::Game() : gameWindow(), assetManager(), spriteAtlas(), playerSprite(nullptr), gameState(), sceneManager(), playerState(), gameLogger(GameLogger::getInstance()),
       playerEntity("Player", generateRandomPlayerColor(), EVec{0, 0}, 1.0f, Inventory(9, 3)) {
 }
 
 int Game::Start() {
-    // Load the scene from the JSON file
-    Scene scene = SceneLoader::loadScene("assets/scene/title.json");
-
-    std::cerr << "Scene entity count: " << scene.getAllEntities().size() << std::endl;
+    // The scene is read once and re-instantiated from the cache whenever it is reloaded.
+    AssetHandle<SceneAsset> titleScene = assetManager.getScene("assets/scene/title.json");
+    uint32_t loadedSceneVersion = 0;
 
-    sceneManager.getScene() = std::move(scene);  // Use move assignment here
+    // Start decoding the sprite atlas pages in the background so they are ready by the time they are drawn.
+    spriteAtlas.load(assetManager, SPRITE_ATLAS_PATH);
+    playerSprite = spriteAtlas.findRegion(PLAYER_SPRITE_REGION);
 
     while (!WindowShouldClose()) {
+        assetManager.update();
+
+        if (titleScene.getVersion() != loadedSceneVersion) {
+            const SceneAsset* sceneAsset = titleScene.get();
+            Scene scene = SceneLoader::loadSceneFromMemory(sceneAsset->bytes.data(), sceneAsset->bytes.size());
+            GAME_LOG_DEBUG("Scene entity count: %zu", scene.getAllEntities().size());
+
+            sceneManager.getScene() = std::move(scene);  // Use move assignment here
+            loadedSceneVersion = titleScene.getVersion();
+        }
+
         // Update game state
         for (const auto& entity : sceneManager.getScene().getAllEntities()) {
             entity->Update();
@@ -222,6 +247,7 @@ int Game::Start() {
         for (const auto& entity : sceneManager.getScene().getAllEntities()) {
             entity->Render();
         }
+        drawPlayer(playerEntity.getPos(), playerEntity.getColor());
 
         EndDrawing();
     }
@@ -230,6 +256,25 @@ int Game::Start() {
 }
 
 
+AssetManager& Game::getAssetManager() {
+    return assetManager;
+}
+
+TextureAtlas& Game::getSpriteAtlas() {
+    return spriteAtlas;
+}
+
+void Game::drawPlayer(EVec position, PlayerColor color) const {
+    Color tint = {color.r, color.g, color.b, color.a};
+    if (playerSprite != nullptr) {
+        Rectangle dest = {position.x, position.y, PLAYER_RADIUS * 2.0f, PLAYER_RADIUS * 2.0f};
+        if (spriteAtlas.drawRegionPro(*playerSprite, dest, Vector2{PLAYER_RADIUS, PLAYER_RADIUS}, 0.0f, tint)) {
+            return;
+        }
+    }
+    DrawCircle(position.x, position.y, PLAYER_RADIUS, tint);
+}
+
 PlayerEntity& Game::getPlayerEntity() {
     return playerEntity;
 }
@@ -2,12 +2,20 @@
 
 #include <raylib.h>
 #include <engine.h>
+#include <logger.h>
 #include <picojson.h>
+#include <asset_manager.h>
+#include <texture_atlas.h>
+
+#include <memory>
 
 #define DEFAULT_WINDOW_WIDTH 1920
 #define DEFAULT_WINDOW_HEIGHT 1080
 #define WINDOW_TITLE "Multiplayer Networking"
 
+/// @brief The atlas region players are drawn with, tinted with their color.
+#define PLAYER_SPRITE_REGION "player/player_icon"
+
 
 class SceneEntity {
 public:
@@ -53,7 +61,48 @@ public:
 
 class SceneLoader {
 public:
+    /// @brief Loads a scene, preferring its compiled binary form when it is present.
+    /// @param filePath The path of the JSON scene.
+    /// @return The loaded scene, or an empty scene on failure.
     static Scene loadScene(const std::string& filePath);
+
+    /// @brief Picks the file loadScene would read for a JSON scene.
+    /// The compiled scene (same path with SCENE_BINARY_EXTENSION) is used when it
+    /// is at least as new as the JSON source.
+    /// @param filePath The path of the JSON scene.
+    /// @return The path of the compiled scene if it should be used, filePath otherwise.
+    static std::string resolveScenePath(const std::string& filePath);
+
+    /// @brief Loads a scene from a buffer holding either a compiled or a JSON scene.
+    /// @param data The scene file contents.
+    /// @param size The size of the buffer in bytes.
+    /// @return The loaded scene, or an empty scene on failure.
+    static Scene loadSceneFromMemory(const unsigned char* data, size_t size);
+
+    /// @brief Loads a JSON scene.
+    /// @param filePath The path of the JSON scene.
+    /// @return The loaded scene, or an empty scene on failure.
+    static Scene loadJsonScene(const std::string& filePath);
+
+    /// @brief Parses a JSON scene held in memory.
+    /// @param data The JSON text.
+    /// @param size The length of the JSON text.
+    /// @return The parsed scene, or an empty scene on failure.
+    static Scene parseJsonScene(const char* data, size_t size);
+
+    /// @brief Loads a compiled scene by memory mapping it.
+    /// @param filePath The path of the compiled scene.
+    /// @param scene The scene to add the entities to.
+    /// @return True if the file was a valid compiled scene, false otherwise.
+    static bool loadBinaryScene(const std::string& filePath, Scene& scene);
+
+    /// @brief Loads a compiled scene held in memory.
+    /// @param data The compiled scene.
+    /// @param size The size of the buffer in bytes.
+    /// @param scene The scene to add the entities to.
+    /// @return True if the buffer was a valid compiled scene, false otherwise.
+    static bool loadBinaryScene(const unsigned char* data, size_t size, Scene& scene);
+
     static void saveScene(const Scene& scene, const std::string& filePath);
 };
 
@@ -86,54 +135,38 @@ public:
     ~GameWindow() noexcept;
 };
 
-/// @brief Defines various log levels for game logging.
-typedef enum {
-    DEBUG = 0,       // Debugging information.
-    WARNING = 10,    // Warnings about potential issues.
-    INFO = 20,       // Informational messages.
-    ERROR = 30,      // Error messages.
-    CRITICAL = 40,   // Critical issues that may halt the game.
-} LogLevel;
-
-/// @brief Provides logging functionalities for the game.
-class GameLogger {
-private:
-    LogLevel logLevel; ///< The current logging level.
-
-public:
-    /// @brief Gets the current logging level.
-    /// @return The current LogLevel.
-    LogLevel getLogLevel();
-
-    /// @brief Sets the logging level.
-    /// @param level The LogLevel to set.
-    void setLogLevel(LogLevel level);
-
-    /// @brief Logs a message with the current logging level.
-    /// @param msg The message to log.
-    void Log(std::string msg);
-
-    /// @brief Logs a message with a specific logging level.
-    /// @param level The LogLevel for the message.
-    /// @param msg The message to log.
-    void Log(LogLevel level, std::string msg);
-};
-
 /// @brief Represents the main game class that manages game state, player, and other components.
 class Game {
 private:
     GameWindow gameWindow;      // The game window properties.
+    AssetManager assetManager;  // Caches textures, fonts and scenes. Declared after gameWindow so it is destroyed first.
+    TextureAtlas spriteAtlas;   // Player and UI sprites packed at build time.
+    const AtlasRegion* playerSprite;   // PLAYER_SPRITE_REGION in spriteAtlas, nullptr until it is loaded or if it is missing.
     PlayerEntity playerEntity;  // The player entity.
     GameState gameState;        // The current state of the game.
     SceneManager sceneManager;  // Manages scenes in the game.
     PlayerState playerState;    // The current state of the player.
-    GameLogger gameLogger;      // Handles game logging.
+    GameLogger& gameLogger;     // Handles game logging (the shared engine logger).
 
 public:
     /// @brief Starts the game loop.
     /// @return An integer representing the exit status of the game.
     int Start();
 
+    /// @brief Gets the asset manager.
+    /// @return A reference to the AssetManager.
+    AssetManager& getAssetManager();
+
+    /// @brief Gets the sprite atlas.
+    /// @return A reference to the TextureAtlas.
+    TextureAtlas& getSpriteAtlas();
+
+    /// @brief Draws a player from the sprite atlas, or as a circle while the atlas is not ready.
+    /// Every player comes from the same atlas page, so raylib batches them without switching textures.
+    /// @param position The center of the player.
+    /// @param color The player's color, used as the tint.
+    void drawPlayer(EVec position, PlayerColor color) const;
+
     /// @brief Gets the player entity.
     /// @return A reference to the PlayerEntity.
     PlayerEntity& getPlayerEntity();
@@ -172,8 +205,8 @@ private:
     Color color;
 
 public:
-    TextEntity(const std::string& text, const EVec& position, const Color& color)
-        : text(text), position(position), color(color){}
+    TextEntity(std::string text, const EVec& position, const Color& color)
+        : text(std::move(text)), position(position), color(color){}
 
     void Update() override;
 
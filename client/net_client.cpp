@@ -0,0 +1,293 @@
+#include "net_client.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cstring>
+
+InventoryMirror::InventoryMirror(const ItemRegistry& registry)
+    : registry(registry), playerInventory(0, 0), craftingGrid(0, 0), container(0, 0), containerId(CONTAINER_PLAYER), synced(false), nextTransactionId(1),
+      rejectedCount(0) {
+}
+
+Inventory* InventoryMirror::find(uint32_t id) {
+    if (id == CONTAINER_PLAYER) {
+        return &playerInventory;
+    }
+    if (id == CONTAINER_CRAFTING) {
+        return &craftingGrid;
+    }
+    return id == containerId ? &container : nullptr;
+}
+
+bool InventoryMirror::handlePacket(const ENetPacket* packet) {
+    if (packet->dataLength == 0) {
+        return false;
+    }
+
+    switch (packet->data[0]) {
+    case INVENTORY_MESSAGE_SYNC:
+        return applySync(packet->data, packet->dataLength);
+    case INVENTORY_MESSAGE_DELTA:
+        return applyDelta(packet->data, packet->dataLength);
+    case INVENTORY_MESSAGE_RESULT: {
+        if (packet->dataLength < sizeof(InventoryTransactionResult)) {
+            return false;
+        }
+        InventoryTransactionResult result;
+        std::memcpy(&result, packet->data, sizeof(result));
+        if (result.result != INVENTORY_OK) {
+            // The corrected slots arrive in a delta, nothing to undo here.
+            ++rejectedCount;
+            GAME_LOG_DEBUG("Inventory transaction %u rejected: %d", result.transactionId, (int)result.result);
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+bool InventoryMirror::applySync(const enet_uint8* data, size_t length) {
+    InventorySyncHeader header;
+    if (length < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    Inventory* target = find(header.containerId);
+    if (target == nullptr) {
+        return false;
+    }
+    Inventory received(header.rows, header.cols);
+    size_t slotCount = size_t(header.rows) * size_t(header.cols);
+    if (size_t(received.getSlotCount()) != slotCount || length != sizeof(header) + slotCount * sizeof(ItemStack)) {
+        return false;
+    }
+    for (size_t i = 0; i < slotCount; ++i) {
+        ItemStack stack;
+        std::memcpy(&stack, data + sizeof(header) + i * sizeof(ItemStack), sizeof(stack));
+        received.setSlot(int(i), stack);
+    }
+
+    *target = received;
+    synced = synced || header.containerId == CONTAINER_PLAYER;
+    return true;
+}
+
+bool InventoryMirror::applyDelta(const enet_uint8* data, size_t length) {
+    InventoryDeltaHeader header;
+    if (length < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    Inventory* target = find(header.containerId);
+    if (target == nullptr || length != sizeof(header) + size_t(header.slotCount) * sizeof(InventorySlotUpdate)) {
+        return false;
+    }
+    for (size_t i = 0; i < header.slotCount; ++i) {
+        InventorySlotUpdate update;
+        std::memcpy(&update, data + sizeof(header) + i * sizeof(update), sizeof(update));
+        if (update.slot >= target->getSlotCount()) {
+            return false;
+        }
+        target->setSlot(update.slot, update.stack);
+    }
+    return true;
+}
+
+ENetPacket* InventoryMirror::createOpenRequest(uint32_t id) {
+    if (id != CONTAINER_PLAYER && id != CONTAINER_CRAFTING && id != containerId) {
+        // Nothing to show until the sync arrives.
+        containerId = id;
+        container = Inventory(0, 0);
+    }
+    InventoryContainerRequest request = {INVENTORY_MESSAGE_OPEN, {0, 0, 0}, id};
+    return enet_packet_create(&request, sizeof(request), ENET_PACKET_FLAG_RELIABLE);
+}
+
+ENetPacket* InventoryMirror::createCloseRequest(uint32_t id) {
+    if (id != CONTAINER_CRAFTING) {
+        containerId = CONTAINER_PLAYER;
+        container = Inventory(0, 0);
+    }
+    InventoryContainerRequest request = {INVENTORY_MESSAGE_CLOSE, {0, 0, 0}, id};
+    return enet_packet_create(&request, sizeof(request), ENET_PACKET_FLAG_RELIABLE);
+}
+
+ENetPacket* InventoryMirror::createCraftRequest(int times) {
+    InventoryCraftRequest request = {INVENTORY_MESSAGE_CRAFT, 0, uint16_t(std::clamp(times, 0, int(UINT16_MAX))), nextTransactionId++};
+    return enet_packet_create(&request, sizeof(request), ENET_PACKET_FLAG_RELIABLE);
+}
+
+ENetPacket* InventoryMirror::createTransaction(InventoryOperation operation, uint32_t fromContainer, int fromSlot, uint32_t toContainer,
+                                               int toSlot, int count) {
+    Inventory* from = find(fromContainer);
+    Inventory* to = find(toContainer);
+    if (from == nullptr || to == nullptr || fromSlot < 0 || fromSlot > UINT8_MAX || toSlot < 0 || toSlot > UINT8_MAX ||
+        count < 0 || count > UINT16_MAX) {
+        return nullptr;
+    }
+    if (applyInventoryOperation(operation, *from, fromSlot, *to, toSlot, count, registry) != INVENTORY_OK) {
+        return nullptr;
+    }
+
+    InventoryTransaction transaction = {INVENTORY_MESSAGE_TRANSACTION, uint8_t(operation), uint8_t(fromSlot), uint8_t(toSlot),
+                                        fromContainer, toContainer, nextTransactionId++, uint16_t(count), 0};
+    return enet_packet_create(&transaction, sizeof(transaction), ENET_PACKET_FLAG_RELIABLE);
+}
+
+const Inventory& InventoryMirror::getPlayerInventory() const {
+    return playerInventory;
+}
+
+const Inventory& InventoryMirror::getCraftingGrid() const {
+    return craftingGrid;
+}
+
+const Inventory* InventoryMirror::getOpenContainer() const {
+    return containerId != CONTAINER_PLAYER && container.getSlotCount() > 0 ? &container : nullptr;
+}
+
+uint32_t InventoryMirror::getOpenContainerId() const {
+    return containerId;
+}
+
+bool InventoryMirror::isSynced() const {
+    return synced;
+}
+
+uint64_t InventoryMirror::getRejectedCount() const {
+    return rejectedCount;
+}
+
+ChatLog::ChatLog() : entries(), receivedCount(0) {
+}
+
+bool ChatLog::handlePacket(const ENetPacket* packet) {
+    ChatBatchHeader header;
+    if (packet->dataLength < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, packet->data, sizeof(header));
+
+    size_t offset = sizeof(header);
+    for (uint16_t i = 0; i < header.count; ++i) {
+        ChatEntryHeader entryHeader;
+        if (packet->dataLength - offset < sizeof(entryHeader)) {
+            return false;
+        }
+        std::memcpy(&entryHeader, packet->data + offset, sizeof(entryHeader));
+        offset += sizeof(entryHeader);
+        if (entryHeader.length > CHAT_MESSAGE_MAX_LENGTH || packet->dataLength - offset < entryHeader.length) {
+            return false;
+        }
+
+        Entry& entry = entries[receivedCount % CHAT_LOG_CAPACITY];
+        entry.playerId = entryHeader.playerId;
+        entry.length = entryHeader.length;
+        std::memcpy(entry.text, packet->data + offset, entryHeader.length);
+        offset += entryHeader.length;
+        ++receivedCount;
+    }
+    return offset == packet->dataLength;
+}
+
+ENetPacket* ChatLog::createMessage(std::string_view text) {
+    if (text.empty()) {
+        return nullptr;
+    }
+    size_t length = std::min(text.size(), size_t(CHAT_MESSAGE_MAX_LENGTH));
+    // Do not cut a UTF-8 sequence in half.
+    while (length < text.size() && length > 0 && (uint8_t(text[length]) & 0xC0) == 0x80) {
+        --length;
+    }
+    return enet_packet_create(text.data(), length, ENET_PACKET_FLAG_RELIABLE);
+}
+
+size_t ChatLog::getCount() const {
+    return size_t(std::min<uint64_t>(receivedCount, CHAT_LOG_CAPACITY));
+}
+
+std::string_view ChatLog::getText(size_t index) const {
+    const Entry& entry = entries[(receivedCount - getCount() + index) % CHAT_LOG_CAPACITY];
+    return std::string_view(entry.text, entry.length);
+}
+
+uint32_t ChatLog::getPlayerId(size_t index) const {
+    return entries[(receivedCount - getCount() + index) % CHAT_LOG_CAPACITY].playerId;
+}
+
+uint64_t ChatLog::getReceivedCount() const {
+    return receivedCount;
+}
+
+bool WorldMirror::handlePacket(const ENetPacket* packet) {
+    if (packet->dataLength == 0) {
+        return false;
+    }
+
+    switch (packet->data[0]) {
+    case WORLD_MESSAGE_CHUNK: {
+        ChunkDataHeader header;
+        if (packet->dataLength < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, packet->data, sizeof(header));
+        if (packet->dataLength != sizeof(header) + size_t(header.runCount) * sizeof(TileRun)) {
+            return false;
+        }
+        std::vector<TileRun> runs(header.runCount);
+        std::memcpy(runs.data(), packet->data + sizeof(header), runs.size() * sizeof(TileRun));
+        Chunk chunk;
+        if (!chunk.decode(runs)) {
+            return false;
+        }
+        chunks.insert_or_assign(chunkKey(header.coord), std::move(chunk));
+        return true;
+    }
+    case WORLD_MESSAGE_UNLOAD: {
+        ChunkUnloadHeader header;
+        if (packet->dataLength < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, packet->data, sizeof(header));
+        if (packet->dataLength != sizeof(header) + size_t(header.count) * sizeof(ChunkCoord)) {
+            return false;
+        }
+        for (size_t i = 0; i < header.count; ++i) {
+            ChunkCoord coord;
+            std::memcpy(&coord, packet->data + sizeof(header) + i * sizeof(coord), sizeof(coord));
+            chunks.erase(chunkKey(coord));
+        }
+        return true;
+    }
+    case WORLD_MESSAGE_TILE: {
+        TileUpdate update;
+        if (packet->dataLength != sizeof(update)) {
+            return false;
+        }
+        std::memcpy(&update, packet->data, sizeof(update));
+        auto it = chunks.find(chunkKey(chunkCoordOfTile(update.tileX, update.tileY)));
+        if (it != chunks.end()) {
+            it->second.setTile(update.tileX & (CHUNK_SIZE - 1), update.tileY & (CHUNK_SIZE - 1), update.tile);
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+TileId WorldMirror::getTile(int32_t tileX, int32_t tileY) const {
+    auto it = chunks.find(chunkKey(chunkCoordOfTile(tileX, tileY)));
+    return it != chunks.end() ? it->second.getTile(tileX & (CHUNK_SIZE - 1), tileY & (CHUNK_SIZE - 1)) : TileId(TILE_AIR);
+}
+
+bool WorldMirror::isLoaded(ChunkCoord coord) const {
+    return chunks.contains(chunkKey(coord));
+}
+
+size_t WorldMirror::getLoadedCount() const {
+    return chunks.size();
+}
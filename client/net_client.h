@@ -0,0 +1,166 @@
+#pragma once
+
+#include <enet.h>
+#include <engine.h>
+#include <protocol.h>
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+/// @brief The number of received chat messages the client keeps.
+#define CHAT_LOG_CAPACITY 64
+
+/// @brief The client's copy of the inventories the server replicates to it: the player's
+/// own inventory, their crafting grid and the world container they have open.
+/// Feed it every packet received on CHANNEL_INVENTORY and send the packets it creates on
+/// the same channel. Transactions are applied locally right away so the UI does not wait
+/// for a round trip; the server's deltas then overwrite the prediction, and when it
+/// rejects a transaction it sends the real contents of the slots involved.
+/// @note Never include raylib next to this header, see EVec.
+class InventoryMirror {
+private:
+    const ItemRegistry& registry;
+    Inventory playerInventory;
+    Inventory craftingGrid;
+    Inventory container;
+    uint32_t containerId;        // The open world container, CONTAINER_PLAYER if none.
+    bool synced;                 // Whether the own inventory was received.
+    uint32_t nextTransactionId;
+    uint64_t rejectedCount;
+
+    Inventory* find(uint32_t id);
+    bool applySync(const enet_uint8* data, size_t length);
+    bool applyDelta(const enet_uint8* data, size_t length);
+
+public:
+    /// @brief Applies a message from the server.
+    /// @param packet A packet received on CHANNEL_INVENTORY.
+    /// @return False if the message was malformed or for a container that is not open.
+    bool handlePacket(const ENetPacket* packet);
+
+    /// @brief Creates a request to open a container; its contents arrive in a sync.
+    /// Opening CONTAINER_PLAYER asks for the own inventory again.
+    /// @param id The container to open.
+    /// @return A new reliable packet, owned by the caller until it is sent.
+    ENetPacket* createOpenRequest(uint32_t id);
+
+    /// @brief Creates a request to close a container.
+    /// @param id The open world container, which is forgotten right away, or CONTAINER_CRAFTING
+    /// to move the crafting grid back into the inventory (when the crafting UI closes).
+    /// @return A new reliable packet, owned by the caller until it is sent.
+    ENetPacket* createCloseRequest(uint32_t id);
+
+    /// @brief Creates a request to craft what the crafting grid makes. Not predicted; the
+    /// grid and inventory changes arrive as deltas.
+    /// @param times The largest number of crafts.
+    /// @return A new reliable packet, owned by the caller until it is sent.
+    ENetPacket* createCraftRequest(int times);
+
+    /// @brief Applies an operation to the local copies and creates the transaction for the server.
+    /// @param operation What to do, see InventoryOperation.
+    /// @param fromContainer CONTAINER_PLAYER, CONTAINER_CRAFTING or the open container.
+    /// @param fromSlot The slot the items come from.
+    /// @param toContainer CONTAINER_PLAYER, CONTAINER_CRAFTING or the open container.
+    /// @param toSlot The slot the items go to.
+    /// @param count The number of items for INVENTORY_SPLIT.
+    /// @return A new reliable packet, owned by the caller until it is sent, or nullptr if the
+    /// operation is not possible on the local copies (the server would reject it too).
+    ENetPacket* createTransaction(InventoryOperation operation, uint32_t fromContainer, int fromSlot, uint32_t toContainer, int toSlot,
+                                  int count);
+
+    /// @brief Gets the local copy of the own inventory.
+    const Inventory& getPlayerInventory() const;
+
+    /// @brief Gets the local copy of the crafting grid. Use a CraftingPreview to show what it makes.
+    const Inventory& getCraftingGrid() const;
+
+    /// @brief Gets the local copy of the open world container.
+    /// @return The container, or nullptr if none is open or its contents have not arrived.
+    const Inventory* getOpenContainer() const;
+
+    /// @brief Gets the id of the open world container.
+    /// @return The id, or CONTAINER_PLAYER if none is open.
+    uint32_t getOpenContainerId() const;
+
+    /// @brief Checks whether the own inventory was received from the server.
+    bool isSynced() const;
+
+    /// @brief Gets the number of transactions the server rejected.
+    uint64_t getRejectedCount() const;
+
+    /// @brief Constructs an empty mirror.
+    /// @param registry The registry holding the stack sizes, for predicting transactions.
+    explicit InventoryMirror(const ItemRegistry& registry);
+};
+
+/// @brief The chat messages received from the server, newest last.
+/// Feed it every packet received on CHANNEL_CHAT and send the packets it creates on the
+/// same channel. Own messages are not shown until the server relays them back, so what
+/// everyone sees is in the same order.
+class ChatLog {
+private:
+    /// @brief A ring slot.
+    struct Entry {
+        uint32_t playerId;
+        uint16_t length;
+        char text[CHAT_MESSAGE_MAX_LENGTH];
+    };
+
+    std::array<Entry, CHAT_LOG_CAPACITY> entries;
+    uint64_t receivedCount;     // Messages ever received; the next one goes to slot receivedCount % capacity.
+
+public:
+    /// @brief Adds the messages of a batch from the server.
+    /// @param packet A packet received on CHANNEL_CHAT.
+    /// @return False if the batch was malformed; the messages before the malformed one are kept.
+    bool handlePacket(const ENetPacket* packet);
+
+    /// @brief Creates a chat message for the server. Longer text is cut at CHAT_MESSAGE_MAX_LENGTH bytes.
+    /// @param text The message, UTF-8 without control characters.
+    /// @return A new reliable packet, owned by the caller until it is sent, or nullptr if the text is empty.
+    static ENetPacket* createMessage(std::string_view text);
+
+    /// @brief Gets the number of messages held, at most CHAT_LOG_CAPACITY.
+    size_t getCount() const;
+
+    /// @brief Gets the text of a held message.
+    /// @param index 0 for the oldest held message, getCount() - 1 for the newest.
+    /// @return A view into the log, valid until the next handlePacket().
+    std::string_view getText(size_t index) const;
+
+    /// @brief Gets the id of the player who wrote a held message.
+    /// @param index 0 for the oldest held message, getCount() - 1 for the newest.
+    uint32_t getPlayerId(size_t index) const;
+
+    /// @brief Gets the number of messages ever received, to tell when new ones arrived.
+    uint64_t getReceivedCount() const;
+
+    ChatLog();
+};
+
+/// @brief The chunks of the tile world the server streamed to the client.
+/// Feed it every packet received on CHANNEL_WORLD. The server sends the chunks around the
+/// player as they come into view and tells the client to drop the ones it left behind, so
+/// the memory held stays proportional to the view, not to the world.
+class WorldMirror {
+private:
+    std::unordered_map<uint64_t, Chunk> chunks;
+
+public:
+    /// @brief Applies a message from the server.
+    /// @param packet A packet received on CHANNEL_WORLD.
+    /// @return False if the message was malformed.
+    bool handlePacket(const ENetPacket* packet);
+
+    /// @brief Gets a tile.
+    /// @return The tile, or TILE_AIR if its chunk is not loaded.
+    TileId getTile(int32_t tileX, int32_t tileY) const;
+
+    /// @brief Checks whether a chunk is loaded.
+    bool isLoaded(ChunkCoord coord) const;
+
+    /// @brief Gets the number of chunks loaded.
+    size_t getLoadedCount() const;
+};
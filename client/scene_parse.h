@@ -0,0 +1,198 @@
+#pragma once
+
+#include <game.h>
+#include <logger.h>
+#include <picojson.h>
+
+#include <string>
+
+// Streaming (SAX-style) parse contexts for JSON scenes.
+//
+// picojson drives these contexts while it walks the input, so entities are
+// created as soon as their JSON object has been read, without building a
+// picojson::value tree or any string-keyed maps first.
+
+/// @brief Base context that rejects every JSON value.
+/// Derived contexts re-declare only the callbacks for the values they accept.
+class SceneDenyParseContext : public picojson::deny_parse_context {
+public:
+    bool parse_object_stop() {
+        return false;
+    }
+};
+
+/// @brief Parses a JSON number into a double.
+class SceneNumberParseContext : public SceneDenyParseContext {
+private:
+    double* out;
+
+public:
+    explicit SceneNumberParseContext(double* out) : out(out) {}
+
+    bool set_number(double f) {
+        *out = f;
+        return true;
+    }
+
+#ifdef PICOJSON_USE_INT64
+    bool set_int64(int64_t i) {
+        *out = static_cast<double>(i);
+        return true;
+    }
+#endif
+};
+
+/// @brief Parses a JSON string into a std::string.
+class SceneStringParseContext : public SceneDenyParseContext {
+private:
+    std::string* out;
+
+public:
+    explicit SceneStringParseContext(std::string* out) : out(out) {}
+
+    template <typename Iter> bool parse_string(picojson::input<Iter>& in) {
+        return picojson::_parse_string(*out, in);
+    }
+};
+
+/// @brief Parses a JSON object of numbers into a fixed set of named fields.
+/// Keys that are not listed are skipped.
+/// @tparam N The number of fields.
+template <size_t N>
+class SceneNumberFieldsParseContext : public SceneDenyParseContext {
+private:
+    const char* const* keys;
+    double* values;
+
+public:
+    SceneNumberFieldsParseContext(const char* const (&keys)[N], double (&values)[N]) : keys(keys), values(values) {}
+
+    bool parse_object_start() {
+        return true;
+    }
+
+    template <typename Iter> bool parse_object_item(picojson::input<Iter>& in, const std::string& key) {
+        for (size_t i = 0; i < N; ++i) {
+            if (key == keys[i]) {
+                SceneNumberParseContext ctx(&values[i]);
+                return picojson::_parse(ctx, in);
+            }
+        }
+        picojson::null_parse_context skip;
+        return picojson::_parse(skip, in);
+    }
+
+    bool parse_object_stop() {
+        return true;
+    }
+};
+
+/// @brief Collects the fields of one entity object.
+/// Holds the union of the fields used by every entity type; build() turns
+/// them into the entity named by "type".
+class SceneEntityParseContext : public SceneDenyParseContext {
+private:
+    static constexpr const char* positionKeys[2] = {"x", "y"};
+    static constexpr const char* colorKeys[4] = {"r", "g", "b", "a"};
+
+    std::string type;
+    std::string text;
+    double position[2] = {0, 0};
+    double color[4] = {0, 0, 0, 0};
+
+public:
+    bool parse_object_start() {
+        return true;
+    }
+
+    template <typename Iter> bool parse_object_item(picojson::input<Iter>& in, const std::string& key) {
+        if (key == "type") {
+            SceneStringParseContext ctx(&type);
+            return picojson::_parse(ctx, in);
+        } else if (key == "text") {
+            SceneStringParseContext ctx(&text);
+            return picojson::_parse(ctx, in);
+        } else if (key == "position") {
+            SceneNumberFieldsParseContext<2> ctx(positionKeys, position);
+            return picojson::_parse(ctx, in);
+        } else if (key == "color") {
+            SceneNumberFieldsParseContext<4> ctx(colorKeys, color);
+            return picojson::_parse(ctx, in);
+        }
+        picojson::null_parse_context skip;
+        return picojson::_parse(skip, in);
+    }
+
+    bool parse_object_stop() {
+        return true;
+    }
+
+    /// @brief Creates the entity described by the parsed fields.
+    /// @return The entity, or nullptr if the type is unknown.
+    std::unique_ptr<SceneEntity> build() {
+        if (type == "TextEntity") {
+            return std::make_unique<TextEntity>(
+                std::move(text),
+                EVec{float(position[0]), float(position[1])},
+                Color{uint8_t(color[0]), uint8_t(color[1]), uint8_t(color[2]), uint8_t(color[3])});
+        }
+        // Add more entity types as needed
+
+        GAME_LOG_WARNING("Could not locate type: '%s'", type.c_str());
+        return nullptr;
+    }
+};
+
+/// @brief Parses the "entities" array, adding each entity to the scene as soon as it is read.
+class SceneEntitiesParseContext : public SceneDenyParseContext {
+private:
+    Scene* scene;
+
+public:
+    explicit SceneEntitiesParseContext(Scene* scene) : scene(scene) {}
+
+    bool parse_array_start() {
+        return true;
+    }
+
+    template <typename Iter> bool parse_array_item(picojson::input<Iter>& in, size_t) {
+        SceneEntityParseContext ctx;
+        if (!picojson::_parse(ctx, in)) {
+            return false;
+        }
+        if (auto entity = ctx.build()) {
+            scene->addEntity(std::move(entity));
+        }
+        return true;
+    }
+
+    bool parse_array_stop(size_t) {
+        return true;
+    }
+};
+
+/// @brief Parses the root scene object.
+class SceneParseContext : public SceneDenyParseContext {
+private:
+    Scene* scene;
+
+public:
+    explicit SceneParseContext(Scene* scene) : scene(scene) {}
+
+    bool parse_object_start() {
+        return true;
+    }
+
+    template <typename Iter> bool parse_object_item(picojson::input<Iter>& in, const std::string& key) {
+        if (key == "entities") {
+            SceneEntitiesParseContext ctx(scene);
+            return picojson::_parse(ctx, in);
+        }
+        picojson::null_parse_context skip;
+        return picojson::_parse(skip, in);
+    }
+
+    bool parse_object_stop() {
+        return true;
+    }
+};
@@ -0,0 +1,99 @@
+#include <texture_atlas.h>
+
+#include <logger.h>
+#include <picojson.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+static double getNumber(const picojson::object& obj, const char* key) {
+    auto it = obj.find(key);
+    return it != obj.end() && it->second.is<double>() ? it->second.get<double>() : 0.0;
+}
+
+bool TextureAtlas::load(AssetManager& assetManager, const std::string& tablePath) {
+    std::ifstream file(tablePath);
+    if (!file.is_open()) {
+        GAME_LOG_ERROR("Failed to open atlas table: %s", tablePath.c_str());
+        return false;
+    }
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    picojson::value v;
+    std::string err = picojson::parse(v, buffer.str());
+    if (!err.empty() || !v.is<picojson::object>()) {
+        GAME_LOG_ERROR("Atlas table parse error: %s", err.c_str());
+        return false;
+    }
+
+    const picojson::object& table = v.get<picojson::object>();
+    auto pagesIt = table.find("pages");
+    auto regionsIt = table.find("regions");
+    if (pagesIt == table.end() || !pagesIt->second.is<picojson::array>() ||
+        regionsIt == table.end() || !regionsIt->second.is<picojson::object>()) {
+        GAME_LOG_ERROR("Atlas table is missing 'pages' or 'regions': %s", tablePath.c_str());
+        return false;
+    }
+
+    pages.clear();
+    regions.clear();
+
+    // Page files are stored next to the table.
+    std::filesystem::path directory = std::filesystem::path(tablePath).parent_path();
+    for (const picojson::value& page : pagesIt->second.get<picojson::array>()) {
+        if (!page.is<picojson::object>() || !page.get("file").is<std::string>()) {
+            GAME_LOG_WARNING("Skipping malformed atlas page in %s", tablePath.c_str());
+            pages.emplace_back();
+            continue;
+        }
+        pages.push_back(assetManager.getTexture((directory / page.get("file").get<std::string>()).string()));
+    }
+
+    for (const auto& [name, region] : regionsIt->second.get<picojson::object>()) {
+        if (!region.is<picojson::object>()) {
+            continue;
+        }
+        const picojson::object& regionObj = region.get<picojson::object>();
+        AtlasRegion atlasRegion;
+        atlasRegion.page = int(getNumber(regionObj, "page"));
+        atlasRegion.source = {
+            float(getNumber(regionObj, "x")),
+            float(getNumber(regionObj, "y")),
+            float(getNumber(regionObj, "width")),
+            float(getNumber(regionObj, "height"))
+        };
+        if (atlasRegion.page < 0 || atlasRegion.page >= int(pages.size())) {
+            GAME_LOG_WARNING("Atlas region '%s' refers to a missing page", name.c_str());
+            continue;
+        }
+        regions.emplace(name, atlasRegion);
+    }
+
+    return true;
+}
+
+const AtlasRegion* TextureAtlas::findRegion(const std::string& name) const {
+    auto it = regions.find(name);
+    return it != regions.end() ? &it->second : nullptr;
+}
+
+bool TextureAtlas::drawRegion(const AtlasRegion& region, Vector2 position, Color tint) const {
+    const Texture2D* texture = pages[region.page].get();
+    if (texture == nullptr) {
+        return false;  // Page is still loading.
+    }
+    DrawTextureRec(*texture, region.source, position, tint);
+    return true;
+}
+
+bool TextureAtlas::drawRegionPro(const AtlasRegion& region, Rectangle dest, Vector2 origin, float rotation, Color tint) const {
+    const Texture2D* texture = pages[region.page].get();
+    if (texture == nullptr) {
+        return false;  // Page is still loading.
+    }
+    DrawTexturePro(*texture, region.source, dest, origin, rotation, tint);
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <raylib.h>
+#include <asset_manager.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Path (relative to the client) of the atlas table the build packs from assets/.
+#define SPRITE_ATLAS_PATH "assets/atlas/atlas.json"
+
+/// @brief A packed image inside a texture atlas page.
+typedef struct {
+    int page;          // Index of the atlas page holding the region.
+    Rectangle source;  // Pixel rectangle of the region inside the page.
+} AtlasRegion;
+
+/// @brief Sprites packed into a few atlas textures by the atlas_packer tool.
+/// Drawing many regions of the same page back to back lets raylib batch them
+/// without switching textures.
+/// @note Resolve regions once with findRegion() and keep the pointer; it stays
+/// valid until the atlas is loaded again.
+class TextureAtlas {
+private:
+    std::vector<AssetHandle<Texture2D>> pages;
+    std::unordered_map<std::string, AtlasRegion> regions;
+
+public:
+    /// @brief Loads an atlas lookup table and starts loading its pages.
+    /// @param assetManager The asset manager used to load the page textures.
+    /// @param tablePath The path of the atlas.json written by atlas_packer.
+    /// @return True if the lookup table was read, false otherwise.
+    bool load(AssetManager& assetManager, const std::string& tablePath);
+
+    /// @brief Finds a region by name.
+    /// @param name The image path relative to the assets directory, without extension (e.g. "player/player_icon").
+    /// @return The region, or nullptr if the atlas has no such image.
+    const AtlasRegion* findRegion(const std::string& name) const;
+
+    /// @brief Draws a region at its natural size.
+    /// @param region The region to draw.
+    /// @param position The top-left corner on screen.
+    /// @param tint The tint to apply (WHITE for none).
+    /// @return False if the region's page is still loading and nothing was drawn.
+    bool drawRegion(const AtlasRegion& region, Vector2 position, Color tint) const;
+
+    /// @brief Draws a region scaled into a destination rectangle, rotated around origin.
+    /// @param region The region to draw.
+    /// @param dest The destination rectangle on screen.
+    /// @param origin The rotation origin, relative to dest.
+    /// @param rotation The rotation in degrees.
+    /// @param tint The tint to apply (WHITE for none).
+    /// @return False if the region's page is still loading and nothing was drawn.
+    bool drawRegionPro(const AtlasRegion& region, Rectangle dest, Vector2 origin, float rotation, Color tint) const;
+};
@@ -0,0 +1,203 @@
+#include <batch_kernels.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BATCH_HAVE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BATCH_TARGET_AVX __attribute__((target("avx")))
+#else
+#define BATCH_TARGET_AVX
+#endif
+
+// The kernels treat an EVec array as one array of interleaved x and y floats, and a
+// WorldVec array as one array of interleaved raw x and y values.
+static_assert(sizeof(EVec) == 2 * sizeof(float), "EVec must be two packed floats");
+static_assert(sizeof(WorldVec) == 2 * sizeof(int32_t) && std::is_standard_layout_v<WorldFixed>, "WorldVec must be two packed int32_t");
+
+namespace {
+
+struct BatchKernels {
+    void (*translate)(float* positions, const float* deltas, size_t count);
+    void (*lerp)(float* positions, const float* targets, float t, size_t count);
+    void (*clamp)(float* positions, EVec min, EVec max, size_t count);
+    void (*applyMovement)(int32_t* positions, const int32_t* deltas, size_t count);
+    const char* name;
+};
+
+// Scalar versions, also used for the tails of the vector versions. count is in floats.
+// The clamp mirrors maxps/minps exactly: x > lo ? x : lo, so NaN turns into lo.
+
+void translateScalar(float* positions, const float* deltas, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        positions[i] = positions[i] + deltas[i];
+    }
+}
+
+void lerpScalar(float* positions, const float* targets, float t, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        positions[i] = positions[i] + t * (targets[i] - positions[i]);
+    }
+}
+
+void clampScalar(float* positions, EVec min, EVec max, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        float lo = i % 2 == 0 ? min.x : min.y;
+        float hi = i % 2 == 0 ? max.x : max.y;
+        float v = positions[i] > lo ? positions[i] : lo;
+        positions[i] = v < hi ? v : hi;
+    }
+}
+
+// count is in int32_t and always even; going through applyMovement keeps the vector version honest.
+void applyMovementScalar(int32_t* positions, const int32_t* deltas, size_t count) {
+    for (size_t i = 0; i + 2 <= count; i += 2) {
+        WorldVec position = {WorldFixed::fromRaw(positions[i]), WorldFixed::fromRaw(positions[i + 1])};
+        WorldVec delta = {WorldFixed::fromRaw(deltas[i]), WorldFixed::fromRaw(deltas[i + 1])};
+        position = applyMovement(position, delta);
+        positions[i] = position.x.getRaw();
+        positions[i + 1] = position.y.getRaw();
+    }
+}
+
+#ifdef BATCH_HAVE_X86
+// SSE2 is part of x86-64, so these need no check.
+
+void translateSse2(float* positions, const float* deltas, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(positions + i, _mm_add_ps(_mm_loadu_ps(positions + i), _mm_loadu_ps(deltas + i)));
+    }
+    translateScalar(positions + i, deltas + i, count - i);
+}
+
+void lerpSse2(float* positions, const float* targets, float t, size_t count) {
+    __m128 tv = _mm_set1_ps(t);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 p = _mm_loadu_ps(positions + i);
+        _mm_storeu_ps(positions + i, _mm_add_ps(p, _mm_mul_ps(tv, _mm_sub_ps(_mm_loadu_ps(targets + i), p))));
+    }
+    lerpScalar(positions + i, targets + i, t, count - i);
+}
+
+void clampSse2(float* positions, EVec min, EVec max, size_t count) {
+    // Four floats are two whole EVecs, so the x/y pattern lines up with every load.
+    __m128 lo = _mm_setr_ps(min.x, min.y, min.x, min.y);
+    __m128 hi = _mm_setr_ps(max.x, max.y, max.x, max.y);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(positions + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(positions + i), lo), hi));
+    }
+    clampScalar(positions + i, min, max, count - i);
+}
+
+// clampToWorld() on four raw values: v > lo ? v : lo, then v < hi ? v : hi. SSE2 has no
+// 32-bit integer min/max, so select with compare masks.
+__m128i clampToWorldSse2(__m128i v) {
+    const __m128i lo = _mm_set1_epi32(-WORLD_LIMIT * WorldFixed::ONE);
+    const __m128i hi = _mm_set1_epi32(WORLD_LIMIT * WorldFixed::ONE);
+    __m128i above = _mm_cmpgt_epi32(v, lo);
+    v = _mm_or_si128(_mm_and_si128(above, v), _mm_andnot_si128(above, lo));
+    __m128i below = _mm_cmpgt_epi32(hi, v);
+    return _mm_or_si128(_mm_and_si128(below, v), _mm_andnot_si128(below, hi));
+}
+
+void applyMovementSse2(int32_t* positions, const int32_t* deltas, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(positions + i));
+        __m128i d = clampToWorldSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(deltas + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(positions + i), clampToWorldSse2(_mm_add_epi32(p, d)));
+    }
+    applyMovementScalar(positions + i, deltas + i, count - i);
+}
+
+BATCH_TARGET_AVX void translateAvx(float* positions, const float* deltas, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(positions + i, _mm256_add_ps(_mm256_loadu_ps(positions + i), _mm256_loadu_ps(deltas + i)));
+    }
+    // The compiler turns the tail call into a jump without vzeroupper; SSE code after
+    // dirty upper halves runs much slower on many CPUs.
+    _mm256_zeroupper();
+    translateSse2(positions + i, deltas + i, count - i);
+}
+
+BATCH_TARGET_AVX void lerpAvx(float* positions, const float* targets, float t, size_t count) {
+    __m256 tv = _mm256_set1_ps(t);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 p = _mm256_loadu_ps(positions + i);
+        _mm256_storeu_ps(positions + i, _mm256_add_ps(p, _mm256_mul_ps(tv, _mm256_sub_ps(_mm256_loadu_ps(targets + i), p))));
+    }
+    _mm256_zeroupper();
+    lerpSse2(positions + i, targets + i, t, count - i);
+}
+
+BATCH_TARGET_AVX void clampAvx(float* positions, EVec min, EVec max, size_t count) {
+    __m256 lo = _mm256_setr_ps(min.x, min.y, min.x, min.y, min.x, min.y, min.x, min.y);
+    __m256 hi = _mm256_setr_ps(max.x, max.y, max.x, max.y, max.x, max.y, max.x, max.y);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(positions + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(positions + i), lo), hi));
+    }
+    _mm256_zeroupper();
+    clampSse2(positions + i, min, max, count - i);
+}
+
+bool cpuHasAvx() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    return (info[2] & (1 << 28)) != 0 && osSavesYmm;
+#else
+    return __builtin_cpu_supports("avx");
+#endif
+}
+#endif
+
+BatchKernels selectKernels() {
+#ifdef BATCH_HAVE_X86
+    if (cpuHasAvx()) {
+        return BatchKernels{&translateAvx, &lerpAvx, &clampAvx, &applyMovementSse2, "avx"};
+    }
+    return BatchKernels{&translateSse2, &lerpSse2, &clampSse2, &applyMovementSse2, "sse2"};
+#else
+    return BatchKernels{&translateScalar, &lerpScalar, &clampScalar, &applyMovementScalar, "scalar"};
+#endif
+}
+
+const BatchKernels kernels = selectKernels();
+
+} // namespace
+
+void batchTranslate(std::span<EVec> positions, std::span<const EVec> deltas) {
+    kernels.translate(reinterpret_cast<float*>(positions.data()), reinterpret_cast<const float*>(deltas.data()), std::min(positions.size(), deltas.size()) * 2);
+}
+
+void batchLerp(std::span<EVec> positions, std::span<const EVec> targets, float t) {
+    kernels.lerp(reinterpret_cast<float*>(positions.data()), reinterpret_cast<const float*>(targets.data()), t, std::min(positions.size(), targets.size()) * 2);
+}
+
+void batchClamp(std::span<EVec> positions, EVec min, EVec max) {
+    kernels.clamp(reinterpret_cast<float*>(positions.data()), min, max, positions.size() * 2);
+}
+
+void batchApplyMovement(std::span<WorldVec> positions, std::span<const WorldVec> deltas) {
+    kernels.applyMovement(reinterpret_cast<int32_t*>(positions.data()), reinterpret_cast<const int32_t*>(deltas.data()), std::min(positions.size(), deltas.size()) * 2);
+}
+
+const char* batchKernelImplementation() {
+    return kernels.name;
+}
@@ -0,0 +1,208 @@
+#include <collision.h>
+#include <batch_kernels.h>
+#include <profiler.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <utility>
+
+// Directions for pushing apart bodies at the same spot, 22.5 degrees apart. Constants instead
+// of std::cos/std::sin, whose last bits differ between C libraries.
+static const EVec COINCIDENT_NORMALS[16] = {
+    {1.0f, 0.0f}, {0.923879533f, 0.382683432f}, {0.707106781f, 0.707106781f}, {0.382683432f, 0.923879533f},
+    {0.0f, 1.0f}, {-0.382683432f, 0.923879533f}, {-0.707106781f, 0.707106781f}, {-0.923879533f, 0.382683432f},
+    {-1.0f, 0.0f}, {-0.923879533f, -0.382683432f}, {-0.707106781f, -0.707106781f}, {-0.382683432f, -0.923879533f},
+    {0.0f, -1.0f}, {0.382683432f, -0.923879533f}, {0.707106781f, -0.707106781f}, {0.923879533f, -0.382683432f},
+};
+
+bool overlapCircleCircle(EVec a, float radiusA, EVec b, float radiusB, EVec& normal, float& depth) {
+    float dx = a.x - b.x;
+    float dy = a.y - b.y;
+    float reach = radiusA + radiusB;
+    float distanceSquared = dx * dx + dy * dy;
+    // Written so that NaN (from a non-finite position) never counts as an overlap.
+    if (!(distanceSquared < reach * reach)) {
+        return false;
+    }
+    float distance = std::sqrt(distanceSquared);
+    // Concentric circles have no direction between them; the caller picks one if it matters.
+    normal = distance > 0.0f ? EVec{dx / distance, dy / distance} : EVec{1.0f, 0.0f};
+    depth = reach - distance;
+    return true;
+}
+
+bool overlapCircleAabb(EVec center, float radius, const Aabb& box, EVec& normal, float& depth) {
+    EVec closest = {std::clamp(center.x, box.min.x, box.max.x), std::clamp(center.y, box.min.y, box.max.y)};
+    float dx = center.x - closest.x;
+    float dy = center.y - closest.y;
+    float distanceSquared = dx * dx + dy * dy;
+    if (!(distanceSquared < radius * radius)) {
+        return false;
+    }
+    if (distanceSquared > 0.0f) {
+        float distance = std::sqrt(distanceSquared);
+        normal = {dx / distance, dy / distance};
+        depth = radius - distance;
+        return true;
+    }
+
+    // The center is inside the box: leave through the nearest side.
+    float left = center.x - box.min.x;
+    float right = box.max.x - center.x;
+    float top = center.y - box.min.y;
+    float bottom = box.max.y - center.y;
+    float nearest = std::min({left, right, top, bottom});
+    normal = nearest == left ? EVec{-1.0f, 0.0f} : nearest == right ? EVec{1.0f, 0.0f} : nearest == top ? EVec{0.0f, -1.0f} : EVec{0.0f, 1.0f};
+    depth = nearest + radius;
+    return true;
+}
+
+bool overlapAabbAabb(const Aabb& a, const Aabb& b) {
+    return a.min.x < b.max.x && b.min.x < a.max.x && a.min.y < b.max.y && b.min.y < a.max.y;
+}
+
+uint64_t CollisionWorld::cellKey(int32_t x, int32_t y) {
+    return uint64_t(uint32_t(x)) << 32 | uint64_t(uint32_t(y));
+}
+
+int32_t CollisionWorld::cellCoordinate(float value) {
+    // Positions can come straight from clients. Converting NaN or a float out of int32 range is
+    // undefined, so NaN goes to cell 0 and everything else is clamped into the world first.
+    if (std::isnan(value)) {
+        return 0;
+    }
+    value = std::clamp(value, -float(WORLD_LIMIT), float(WORLD_LIMIT));
+    return int32_t(std::floor(value / COLLISION_CELL_SIZE));
+}
+
+void CollisionWorld::addObstacle(const Aabb& box) {
+    int index = int(obstacles.size());
+    obstacles.push_back(box);
+    for (int32_t y = cellCoordinate(box.min.y); y <= cellCoordinate(box.max.y); ++y) {
+        for (int32_t x = cellCoordinate(box.min.x); x <= cellCoordinate(box.max.x); ++x) {
+            obstacleCells[cellKey(x, y)].push_back(index);
+        }
+    }
+}
+
+void CollisionWorld::clearObstacles() {
+    obstacles.clear();
+    obstacleCells.clear();
+}
+
+std::span<const Aabb> CollisionWorld::getObstacles() const {
+    return obstacles;
+}
+
+void CollisionWorld::findBodyContacts(std::span<const EVec> positions, float radius) {
+    const size_t count = positions.size();
+    const uint32_t bucketCount = std::bit_ceil(uint32_t(std::max<size_t>(count * 2, 16)));
+    const int shift = 64 - std::countr_zero(bucketCount);
+    auto bucket = [shift](int32_t x, int32_t y) { return uint32_t((cellKey(x, y) * 0x9E3779B97F4A7C15ull) >> shift); };
+
+    // Counting sort by bucket; afterwards bucket b holds sorted[b == 0 ? 0 : bucketStart[b - 1], bucketStart[b]).
+    bucketOf.resize(count);
+    sorted.resize(count);
+    bucketStart.assign(bucketCount, 0);
+    for (size_t i = 0; i < count; ++i) {
+        bucketOf[i] = bucket(cellCoordinate(positions[i].x), cellCoordinate(positions[i].y));
+        ++bucketStart[bucketOf[i]];
+    }
+    uint32_t start = 0;
+    for (uint32_t& b : bucketStart) {
+        start += std::exchange(b, start);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        sorted[bucketStart[bucketOf[i]]++] = int(i);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        int32_t cellX = cellCoordinate(positions[i].x);
+        int32_t cellY = cellCoordinate(positions[i].y);
+        // Neighbouring cells can share a bucket; visit each bucket once.
+        uint32_t visited[9];
+        int visitedCount = 0;
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                uint32_t b = bucket(cellX + dx, cellY + dy);
+                if (std::find(visited, visited + visitedCount, b) != visited + visitedCount) {
+                    continue;
+                }
+                visited[visitedCount++] = b;
+
+                for (uint32_t k = b == 0 ? 0 : bucketStart[b - 1]; k < bucketStart[b]; ++k) {
+                    int j = sorted[k];
+                    Contact contact = {int(i), j, {}, 0.0f};
+                    if (j <= int(i) || !overlapCircleCircle(positions[i], radius, positions[j], radius, contact.normal, contact.depth) ||
+                        contact.depth < COLLISION_SLOP) {
+                        continue;
+                    }
+                    if (positions[i].x == positions[j].x && positions[i].y == positions[j].y) {
+                        // Bodies spawned on the same spot: spread each pair in its own direction,
+                        // derived from the indices so every run resolves the pile the same way.
+                        // Stepping by 7 of 16 puts consecutive pairs far apart.
+                        contact.normal = COINCIDENT_NORMALS[(i * 31 + size_t(j)) * 7 % 16];
+                    }
+                    contacts.push_back(contact);
+                }
+            }
+        }
+    }
+}
+
+void CollisionWorld::findObstacleContacts(std::span<const EVec> positions, float radius) {
+    if (obstacleCells.empty()) {
+        return;
+    }
+    for (size_t i = 0; i < positions.size(); ++i) {
+        // A body is at most one cell wide, so it covers at most 2x2 cells.
+        const EVec p = positions[i];
+        int32_t minX = cellCoordinate(p.x - radius), maxX = cellCoordinate(p.x + radius);
+        int32_t minY = cellCoordinate(p.y - radius), maxY = cellCoordinate(p.y + radius);
+        for (int32_t y = minY; y <= maxY; ++y) {
+            for (int32_t x = minX; x <= maxX; ++x) {
+                auto cell = obstacleCells.find(cellKey(x, y));
+                if (cell == obstacleCells.end()) {
+                    continue;
+                }
+                for (int obstacle : cell->second) {
+                    // An obstacle covering several of these cells is tested in the first of them only.
+                    const Aabb& box = obstacles[size_t(obstacle)];
+                    if (x != std::max(minX, cellCoordinate(box.min.x)) || y != std::max(minY, cellCoordinate(box.min.y))) {
+                        continue;
+                    }
+                    Contact contact = {int(i), COLLISION_STATIC, {}, 0.0f};
+                    if (overlapCircleAabb(p, radius, box, contact.normal, contact.depth) && contact.depth >= COLLISION_SLOP) {
+                        contacts.push_back(contact);
+                    }
+                }
+            }
+        }
+    }
+}
+
+size_t CollisionWorld::resolve(std::span<EVec> positions, float radius) {
+    PROFILE_FUNCTION();
+    contacts.clear();
+    findBodyContacts(positions, radius);
+    findObstacleContacts(positions, radius);
+
+    // Jacobi style: every push is computed from the positions before any of them moved.
+    corrections.assign(positions.size(), EVec{0.0f, 0.0f});
+    for (const Contact& contact : contacts) {
+        float share = contact.b == COLLISION_STATIC ? contact.depth : contact.depth * 0.5f;
+        corrections[size_t(contact.a)].x += contact.normal.x * share;
+        corrections[size_t(contact.a)].y += contact.normal.y * share;
+        if (contact.b != COLLISION_STATIC) {
+            corrections[size_t(contact.b)].x -= contact.normal.x * share;
+            corrections[size_t(contact.b)].y -= contact.normal.y * share;
+        }
+    }
+    batchTranslate(positions, corrections);
+    return contacts.size();
+}
+
+std::span<const Contact> CollisionWorld::getContacts() const {
+    return contacts;
+}
@@ -0,0 +1,255 @@
+#include <crafting.h>
+#include <json_field.h>
+#include <mapped_file.h>
+#include <profiler.h>
+
+#include <algorithm>
+#include <bit>
+
+uint64_t RecipeBook::ingredientHash(ItemId id, int slots) {
+    if (slots <= 0) {
+        return 0;
+    }
+    // splitmix64 finalizer: spreads (id, slots) over all 64 bits so sums of terms rarely collide.
+    uint64_t z = (uint64_t(id) << 32 | uint64_t(uint32_t(slots))) + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+bool RecipeBook::addRecipe(std::span<const ItemStack> ingredients, ItemStack result, const ItemRegistry& registry, std::string& err) {
+    if (!registry.isValid(result.id) || result.count == 0 || result.count > registry.getMaxStackSize(result.id)) {
+        err = "recipe result must be a known item and fit in one stack";
+        return false;
+    }
+
+    // Canonical form: one entry per item, sorted by id.
+    Recipe recipe{{}, result};
+    int totalSlots = 0;
+    for (const ItemStack& ingredient : ingredients) {
+        if (!registry.isValid(ingredient.id) || ingredient.count == 0) {
+            err = "recipe for '" + std::string(registry.getName(result.id)) + "' has an unknown or empty ingredient";
+            return false;
+        }
+        auto it = std::find_if(recipe.ingredients.begin(), recipe.ingredients.end(),
+                               [&](const ItemStack& existing) { return existing.id == ingredient.id; });
+        if (it != recipe.ingredients.end()) {
+            it->count = uint16_t(it->count + ingredient.count);
+        } else {
+            recipe.ingredients.push_back(ingredient);
+        }
+        totalSlots += ingredient.count;
+    }
+    if (recipe.ingredients.empty() || totalSlots > INVENTORY_MAX_SLOTS) {
+        err = "recipe for '" + std::string(registry.getName(result.id)) + "' needs between 1 and " + std::to_string(INVENTORY_MAX_SLOTS) + " ingredients";
+        return false;
+    }
+    std::sort(recipe.ingredients.begin(), recipe.ingredients.end(), [](const ItemStack& a, const ItemStack& b) { return a.id < b.id; });
+
+    uint64_t hash = 0;
+    for (const ItemStack& ingredient : recipe.ingredients) {
+        hash += ingredientHash(ingredient.id, ingredient.count);
+    }
+    auto existing = index.find(hash);
+    if (existing != index.end()) {
+        const Recipe& other = recipes[size_t(existing->second)];
+        err = find(hash, recipe.ingredients) != RECIPE_NONE
+            ? "recipes for '" + std::string(registry.getName(other.result.id)) + "' and '" + std::string(registry.getName(result.id)) + "' have the same ingredients"
+            : "recipe for '" + std::string(registry.getName(result.id)) + "' collides with the index of '" + std::string(registry.getName(other.result.id)) + "'";
+        return false;
+    }
+
+    index.emplace(hash, int(recipes.size()));
+    recipes.push_back(std::move(recipe));
+    return true;
+}
+
+bool RecipeBook::loadFromJson(const char* json, size_t length, const ItemRegistry& registry, std::string& err) {
+    picojson::value v;
+    picojson::parse(v, json, json + length, &err);
+    if (!err.empty()) {
+        return false;
+    }
+    if (!v.is<picojson::object>() || !getJsonField(v.get<picojson::object>(), "recipes").is<picojson::array>()) {
+        err = "recipe file has no 'recipes' array";
+        return false;
+    }
+
+    std::vector<ItemStack> ingredients;
+    for (const picojson::value& entry : getJsonField(v.get<picojson::object>(), "recipes").get<picojson::array>()) {
+        if (!entry.is<picojson::object>()) {
+            err = "recipe is not an object";
+            return false;
+        }
+        const picojson::value& ingredientsValue = getJsonField(entry.get<picojson::object>(), "ingredients");
+        const picojson::value& resultValue = getJsonField(entry.get<picojson::object>(), "result");
+        if (!ingredientsValue.is<picojson::object>() || !resultValue.is<picojson::object>()) {
+            err = "recipe needs an 'ingredients' object and a 'result' object";
+            return false;
+        }
+
+        ingredients.clear();
+        for (const auto& [name, slots] : ingredientsValue.get<picojson::object>()) {
+            ItemId id = registry.findId(name);
+            if (id == ITEM_NONE || !slots.is<double>() || slots.get<double>() < 1 || slots.get<double>() > INVENTORY_MAX_SLOTS) {
+                err = "recipe ingredient '" + name + "' is unknown or has a bad count";
+                return false;
+            }
+            ingredients.push_back(ItemStack{id, uint16_t(slots.get<double>())});
+        }
+
+        const picojson::object& resultObj = resultValue.get<picojson::object>();
+        const picojson::value& item = getJsonField(resultObj, "item");
+        const picojson::value& count = getJsonField(resultObj, "count");
+        ItemId resultId = item.is<std::string>() ? registry.findId(item.get<std::string>()) : ItemId(ITEM_NONE);
+        double resultCount = count.is<double>() ? count.get<double>() : 1.0;
+        if (resultId == ITEM_NONE || resultCount < 1 || resultCount > 0xFFFF) {
+            err = "recipe result needs a known 'item' and a positive 'count'";
+            return false;
+        }
+
+        if (!addRecipe(ingredients, ItemStack{resultId, uint16_t(resultCount)}, registry, err)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RecipeBook::loadFromFile(const std::string& path, const ItemRegistry& registry, std::string& err) {
+    MappedFile file;
+    if (!file.open(path)) {
+        err = "could not read " + path;
+        return false;
+    }
+    return loadFromJson(reinterpret_cast<const char*>(file.data()), file.size(), registry, err);
+}
+
+int RecipeBook::find(uint64_t hash, std::span<const ItemStack> ingredients) const {
+    auto it = index.find(hash);
+    if (it == index.end()) {
+        return RECIPE_NONE;
+    }
+
+    // Confirm the match, the hash alone could collide with a multiset that has no recipe.
+    const Recipe& recipe = recipes[size_t(it->second)];
+    if (recipe.ingredients.size() != ingredients.size()) {
+        return RECIPE_NONE;
+    }
+    for (const ItemStack& ingredient : ingredients) {
+        auto match = std::lower_bound(recipe.ingredients.begin(), recipe.ingredients.end(), ingredient.id,
+                                      [](const ItemStack& stack, ItemId id) { return stack.id < id; });
+        if (match == recipe.ingredients.end() || match->id != ingredient.id || match->count != ingredient.count) {
+            return RECIPE_NONE;
+        }
+    }
+    return it->second;
+}
+
+const Recipe& RecipeBook::getRecipe(int recipeIndex) const {
+    return recipes[size_t(recipeIndex)];
+}
+
+size_t RecipeBook::getCount() const {
+    return recipes.size();
+}
+
+void RecipeBook::clear() {
+    recipes.clear();
+    index.clear();
+}
+
+CraftingPreview::CraftingPreview() : slotItems(), ingredients(), ingredientCount(0), hash(0), recipeIndex(RECIPE_NONE) {
+}
+
+void CraftingPreview::reset() {
+    slotItems.fill(ITEM_NONE);
+    ingredientCount = 0;
+    hash = 0;
+    recipeIndex = RECIPE_NONE;
+}
+
+void CraftingPreview::changeIngredient(ItemId id, int delta) {
+    int i = 0;
+    while (i < ingredientCount && ingredients[size_t(i)].id != id) {
+        ++i;
+    }
+    if (i == ingredientCount) {
+        ingredients[size_t(ingredientCount++)] = ItemStack{id, 0};
+    }
+
+    int slots = ingredients[size_t(i)].count;
+    hash += RecipeBook::ingredientHash(id, slots + delta) - RecipeBook::ingredientHash(id, slots);
+    ingredients[size_t(i)].count = uint16_t(slots + delta);
+    if (ingredients[size_t(i)].count == 0) {
+        ingredients[size_t(i)] = ingredients[size_t(--ingredientCount)];
+    }
+}
+
+void CraftingPreview::update(const Inventory& grid, uint64_t changedSlots, const RecipeBook& book) {
+    bool changed = false;
+    for (; changedSlots != 0; changedSlots &= changedSlots - 1) {
+        int slot = std::countr_zero(changedSlots);
+        if (slot >= grid.getSlotCount()) {
+            break;
+        }
+        ItemId current = grid.getSlot(slot).id;
+        if (current == slotItems[size_t(slot)]) {
+            continue;
+        }
+        if (slotItems[size_t(slot)] != ITEM_NONE) {
+            changeIngredient(slotItems[size_t(slot)], -1);
+        }
+        if (current != ITEM_NONE) {
+            changeIngredient(current, +1);
+        }
+        slotItems[size_t(slot)] = current;
+        changed = true;
+    }
+
+    if (changed) {
+        recipeIndex = ingredientCount > 0 ? book.find(hash, std::span<const ItemStack>(ingredients.data(), size_t(ingredientCount))) : RECIPE_NONE;
+    }
+}
+
+int CraftingPreview::craft(Inventory& grid, Inventory& output, int times, const RecipeBook& book, const ItemRegistry& registry) {
+    PROFILE_FUNCTION();
+    update(grid, ~uint64_t(0), book);
+    if (recipeIndex == RECIPE_NONE || times <= 0) {
+        return 0;
+    }
+
+    // Every craft takes one item from each occupied slot, so the smallest stack limits the count.
+    uint64_t occupied = 0;
+    for (int i = 0; i < grid.getSlotCount(); ++i) {
+        ItemStack stack = grid.getSlot(i);
+        if (stack.id != ITEM_NONE) {
+            times = std::min(times, int(stack.count));
+            occupied |= uint64_t(1) << i;
+        }
+    }
+
+    // More crafts than the whole output could hold never fit; this also keeps times * result.count
+    // (up to 64 slots of 65535 items) far from overflowing.
+    const ItemStack result = book.getRecipe(recipeIndex).result;
+    times = std::min(times, output.getSlotCount() * int(registry.getMaxStackSize(result.id)) / int(result.count));
+    if (times == 0) {
+        return 0;
+    }
+
+    // Find out how many whole crafts fit on a copy; copying an inventory does not allocate.
+    Inventory trial = output;
+    int placed = times * result.count - trial.add(result.id, times * result.count, registry);
+    times = placed / result.count;
+    if (times == 0) {
+        return 0;
+    }
+
+    output.add(result.id, times * result.count, registry);
+    for (uint64_t slots = occupied; slots != 0; slots &= slots - 1) {
+        int slot = std::countr_zero(slots);
+        ItemStack stack = grid.getSlot(slot);
+        grid.setSlot(slot, ItemStack{stack.id, uint16_t(stack.count - times)});
+    }
+    update(grid, occupied, book);
+    return times;
+}
@@ -1,23 +1,22 @@
 #include <engine.h>
+#include <rng.h>
 
-#include <random>
+#include <algorithm>
 
 PlayerColor generateRandomPlayerColor() {
-    std::random_device randomDevice;
-    // Use Mersenne Twister engine for generating random numbers
-    std::mt19937 gen(randomDevice());
-    std::uniform_int_distribution<std::mt19937::result_type> dist(0, 255);
+    // One number holds all three channels.
+    uint64_t bits = Random::getThreadLocal().next();
 
     PlayerColor randomColor;
-    randomColor.r = dist(gen);
-    randomColor.g = dist(gen);
-    randomColor.b = dist(gen);
+    randomColor.r = (unsigned char)(bits);
+    randomColor.g = (unsigned char)(bits >> 8);
+    randomColor.b = (unsigned char)(bits >> 16);
     randomColor.a = 255; // Player colors can't be transparent.
 
     return randomColor;
 }
 
-std::string PlayerEntity::getName() const {
+std::string_view PlayerEntity::getName() const {
     return name;
 }
 
@@ -34,11 +33,11 @@ void PlayerEntity::setColor(const PlayerColor& c) {
 }
 
 EVec PlayerEntity::getPos() const {
-    return pos;
+    return toFloat(pos);
 }
 
 void PlayerEntity::setPos(const EVec& vec) {
-    pos = vec;
+    pos = toFixed<WorldFixed>(vec);
 }
 
 float PlayerEntity::getHealth() const {
@@ -49,12 +48,22 @@ void PlayerEntity::setHealth(float h) {
     health = h;
 }
 
-Inventory PlayerEntity::getInventory() {
+const Inventory& PlayerEntity::getInventory() const {
+    return inventory;
+}
+
+Inventory& PlayerEntity::getInventory() {
     return inventory;
 }
 
 void PlayerEntity::move(const EVec& vec) {
-    pos = Lerp(pos, vec, 0.1f);  // Smooth out movement using interpolation
+    // Smooth out movement using interpolation
+    const WorldVec target = toFixed<WorldFixed>(vec);
+    const WorldVec step = (target - pos) * WorldFixed(0.1f);
+    // The multiply rounds down, so towards larger coordinates the step becomes 0 a few 1/256
+    // short of the target; snap there instead of stopping short.
+    pos.x = step.x == WorldFixed() ? target.x : pos.x + step.x;
+    pos.y = step.y == WorldFixed() ? target.y : pos.y + step.y;
 }
 
 bool PlayerEntity::takeDamage(float amount) {
@@ -67,11 +76,139 @@ bool PlayerEntity::takeDamage(float amount) {
 }
 
 
-EVec Lerp(const EVec& start, const EVec& end, float t) {
-    EVec result;
-    result.x = start.x + t * (end.x - start.x);
-    result.y = start.y + t * (end.y - start.y);
-    return result;
+Inventory::Inventory(int r, int c) : slots(), dirtySlots(0), rows(r > 0 ? r : 0), cols(c > 0 ? c : 0) {
+    if (cols > 0 && rows * cols > INVENTORY_MAX_SLOTS) {
+        rows = INVENTORY_MAX_SLOTS / cols;
+    }
+    if (rows == 0 || cols > INVENTORY_MAX_SLOTS) {
+        rows = 0;
+        cols = 0;
+    }
+}
+
+void Inventory::setSlot(int index, ItemStack stack) {
+    if (stack.id == ITEM_NONE || stack.count == 0) {
+        stack = ItemStack{ITEM_NONE, 0};
+    }
+    if (slots[size_t(index)].id != stack.id || slots[size_t(index)].count != stack.count) {
+        slots[size_t(index)] = stack;
+        markSlotDirty(index);
+    }
+}
+
+int Inventory::add(ItemId id, int count, const ItemRegistry& registry) {
+    int maxStackSize = registry.getMaxStackSize(id);
+    if (maxStackSize == 0) {
+        return count;
+    }
+
+    int slotCount = getSlotCount();
+    for (int i = 0; i < slotCount && count > 0; ++i) {
+        if (slots[size_t(i)].id == id && slots[size_t(i)].count < maxStackSize) {
+            int moved = std::min(count, maxStackSize - int(slots[size_t(i)].count));
+            setSlot(i, ItemStack{id, uint16_t(slots[size_t(i)].count + moved)});
+            count -= moved;
+        }
+    }
+    for (int i = 0; i < slotCount && count > 0; ++i) {
+        if (slots[size_t(i)].id == ITEM_NONE) {
+            int moved = std::min(count, maxStackSize);
+            setSlot(i, ItemStack{id, uint16_t(moved)});
+            count -= moved;
+        }
+    }
+    return count;
+}
+
+int Inventory::remove(ItemId id, int count) {
+    int removed = 0;
+    for (int i = getSlotCount() - 1; i >= 0 && removed < count; --i) {
+        if (slots[size_t(i)].id == id) {
+            int taken = std::min(count - removed, int(slots[size_t(i)].count));
+            setSlot(i, ItemStack{id, uint16_t(slots[size_t(i)].count - taken)});
+            removed += taken;
+        }
+    }
+    return removed;
+}
+
+int Inventory::countOf(ItemId id) const {
+    int total = 0;
+    for (int i = 0; i < getSlotCount(); ++i) {
+        if (slots[size_t(i)].id == id) {
+            total += slots[size_t(i)].count;
+        }
+    }
+    return total;
+}
+
+void Inventory::clear() {
+    for (int i = 0; i < getSlotCount(); ++i) {
+        setSlot(i, ItemStack{ITEM_NONE, 0});
+    }
+}
+
+InventoryResult applyInventoryOperation(InventoryOperation operation, Inventory& from, int fromSlot, Inventory& to, int toSlot,
+                                        int count, const ItemRegistry& registry) {
+    if (toSlot < 0 || toSlot >= to.getSlotCount()) {
+        return INVENTORY_INVALID_SLOT;
+    }
+    ItemStack target = to.getSlot(toSlot);
+
+    if (operation == INVENTORY_MERGE) {
+        if (target.id == ITEM_NONE) {
+            return INVENTORY_EMPTY_SLOT;
+        }
+        int room = int(registry.getMaxStackSize(target.id)) - int(target.count);
+        for (int i = 0; i < from.getSlotCount() && room > 0; ++i) {
+            ItemStack source = from.getSlot(i);
+            if (source.id != target.id || (&from == &to && i == toSlot)) {
+                continue;
+            }
+            int moved = std::min(room, int(source.count));
+            from.setSlot(i, ItemStack{source.id, uint16_t(source.count - moved)});
+            target.count = uint16_t(target.count + moved);
+            room -= moved;
+        }
+        to.setSlot(toSlot, target);
+        return INVENTORY_OK;
+    }
+
+    if (fromSlot < 0 || fromSlot >= from.getSlotCount() || (&from == &to && fromSlot == toSlot)) {
+        return INVENTORY_INVALID_SLOT;
+    }
+    ItemStack source = from.getSlot(fromSlot);
+    if (source.id == ITEM_NONE) {
+        return INVENTORY_EMPTY_SLOT;
+    }
+    int room = target.id == ITEM_NONE ? int(registry.getMaxStackSize(source.id))
+             : target.id == source.id ? int(registry.getMaxStackSize(source.id)) - int(target.count)
+             : 0;
+
+    if (operation == INVENTORY_MOVE) {
+        if (target.id != ITEM_NONE && target.id != source.id) {
+            from.setSlot(fromSlot, target);
+            to.setSlot(toSlot, source);
+            return INVENTORY_OK;
+        }
+        count = std::min(int(source.count), room);
+        if (count == 0) {
+            return INVENTORY_NO_ROOM;
+        }
+    } else if (operation == INVENTORY_SPLIT) {
+        if (count <= 0 || count > int(source.count)) {
+            return INVENTORY_INVALID_COUNT;
+        }
+        if (count > room) {
+            return INVENTORY_NO_ROOM;
+        }
+    } else {
+        return INVENTORY_INVALID_OPERATION;
+    }
+
+    from.setSlot(fromSlot, ItemStack{source.id, uint16_t(source.count - count)});
+    to.setSlot(toSlot, ItemStack{source.id, uint16_t(to.getSlot(toSlot).count + count)});
+    return INVENTORY_OK;
 }
 
 
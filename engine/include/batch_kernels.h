@@ -0,0 +1,37 @@
+#pragma once
+
+#include <engine.h>
+
+#include <span>
+
+// Kernels that update whole arrays of positions at once, for per-tick integration and
+// interpolation over every entity. They use AVX or SSE2 when the CPU has them, chosen once
+// at startup, and fall back to scalar code elsewhere. Every implementation performs the
+// same float operations in the same order, so results do not depend on the CPU. The
+// fixed-point kernel uses SSE2 on any x86-64, as AVX has no 256-bit integer operations.
+
+/// @brief Adds a delta to each position: positions[i] += deltas[i].
+/// @param positions The positions, updated in place.
+/// @param deltas One delta per position.
+void batchTranslate(std::span<EVec> positions, std::span<const EVec> deltas);
+
+/// @brief Moves each position towards its target: positions[i] = Lerp(positions[i], targets[i], t).
+/// @param positions The positions, updated in place.
+/// @param targets One target per position.
+/// @param t How far to go towards the targets.
+void batchLerp(std::span<EVec> positions, std::span<const EVec> targets, float t);
+
+/// @brief Clamps each position into a box. NaN components become the minimum.
+/// @param positions The positions, updated in place.
+/// @param min The smallest allowed coordinates.
+/// @param max The largest allowed coordinates.
+void batchClamp(std::span<EVec> positions, EVec min, EVec max);
+
+/// @brief Applies one movement input to each position: positions[i] = applyMovement(positions[i], deltas[i]).
+/// Bit-identical to applyMovement<WorldFixed> on every CPU; the server integrates movement with it.
+/// @param positions The positions, updated in place.
+/// @param deltas One movement input per position.
+void batchApplyMovement(std::span<WorldVec> positions, std::span<const WorldVec> deltas);
+
+/// @brief Gets the name of the kernels in use ("avx", "sse2" or "scalar"), for logs and benchmarks.
+const char* batchKernelImplementation();
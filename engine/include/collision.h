@@ -0,0 +1,104 @@
+#pragma once
+
+#include <engine.h>
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+/// @brief The side of a broadphase grid cell. Bodies may be at most this wide
+/// (radius at most half of it), so a body only touches bodies in its own and the eight
+/// neighbouring cells.
+#define COLLISION_CELL_SIZE 64.0f
+
+/// @brief Overlaps shallower than this are ignored, so bodies resting against each other
+/// do not count as moved every tick because of rounding.
+#define COLLISION_SLOP 0.01f
+
+/// @brief Contact::b for a contact with a static obstacle.
+#define COLLISION_STATIC -1
+
+/// @brief An axis aligned box.
+typedef struct {
+    EVec min;  // The corner with the smallest coordinates.
+    EVec max;  // The corner with the largest coordinates.
+} Aabb;
+
+/// @brief Two shapes that overlap, and how to separate them.
+typedef struct {
+    int a;          // The body that is pushed along the normal.
+    int b;          // The other body, or COLLISION_STATIC for an obstacle.
+    EVec normal;    // Unit vector pointing from b towards a.
+    float depth;    // How far the shapes overlap along the normal.
+} Contact;
+
+/// @brief Tests two circles for overlap.
+/// @param normal Set to the unit vector from b towards a if they overlap.
+/// @param depth Set to the overlap along the normal if they overlap.
+/// @return True if the circles overlap.
+bool overlapCircleCircle(EVec a, float radiusA, EVec b, float radiusB, EVec& normal, float& depth);
+
+/// @brief Tests a circle and a box for overlap.
+/// @param normal Set to the unit vector pushing the circle out of the box if they overlap.
+/// @param depth Set to the distance the circle must move along the normal if they overlap.
+/// @return True if they overlap.
+bool overlapCircleAabb(EVec center, float radius, const Aabb& box, EVec& normal, float& depth);
+
+/// @brief Tests two boxes for overlap.
+/// @return True if they overlap.
+bool overlapAabbAabb(const Aabb& a, const Aabb& b);
+
+/// @brief Keeps circular bodies (players) out of each other and out of static boxes (the world).
+///
+/// The broadphase is a uniform grid, rebuilt every resolve() by counting sort into a hash
+/// table about twice the size of the body count, so finding contacts costs O(bodies + contacts)
+/// no matter how the bodies are spread. Static boxes are bucketed into the cells they cover
+/// once, when they are added. All buffers are kept between calls, so resolving does not
+/// allocate once they have grown to the body count.
+class CollisionWorld {
+private:
+    std::vector<Aabb> obstacles;
+    std::unordered_map<uint64_t, std::vector<int>> obstacleCells;   // Cell key -> obstacles covering it.
+
+    // Broadphase scratch, reused across calls.
+    std::vector<uint32_t> bucketOf;     // Body -> hash bucket.
+    std::vector<uint32_t> bucketStart;  // Bucket -> first index into sorted, counting sort style.
+    std::vector<int> sorted;            // Bodies ordered by bucket.
+    std::vector<EVec> corrections;      // Accumulated push per body.
+    std::vector<Contact> contacts;
+
+    static uint64_t cellKey(int32_t x, int32_t y);
+    static int32_t cellCoordinate(float value);
+
+    /// @brief Finds the contacts between bodies.
+    void findBodyContacts(std::span<const EVec> positions, float radius);
+
+    /// @brief Finds the contacts between bodies and obstacles.
+    void findObstacleContacts(std::span<const EVec> positions, float radius);
+
+public:
+    /// @brief Adds a static box that bodies cannot enter.
+    /// @param box The box.
+    void addObstacle(const Aabb& box);
+
+    /// @brief Removes every static box.
+    void clearObstacles();
+
+    /// @brief Gets the static boxes.
+    std::span<const Aabb> getObstacles() const;
+
+    /// @brief Pushes overlapping bodies apart and out of the obstacles.
+    /// Overlapping bodies move away from each other by half the overlap each; a body in an
+    /// obstacle moves all the way out. Deep piles take a few ticks to settle. Bodies at
+    /// non-finite positions touch nothing and are left as they are. The result depends on the
+    /// order of the bodies (the pushes are summed in it), so keep the order stable between runs.
+    /// @param positions The center of every body, updated in place.
+    /// @param radius The radius of every body, at most COLLISION_CELL_SIZE / 2.
+    /// @return The number of contacts found, see getContacts().
+    size_t resolve(std::span<EVec> positions, float radius);
+
+    /// @brief Gets the contacts the last resolve() found, before they were resolved.
+    /// Body contacts are listed once, with a < b.
+    std::span<const Contact> getContacts() const;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <engine.h>
+#include <item_registry.h>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Path (relative to the executable) of the recipes shipped in assets/.
+#define RECIPE_BOOK_PATH "assets/recipes.json"
+
+/// @brief Returned by CraftingPreview::getRecipeIndex() when the grid matches no recipe.
+#define RECIPE_NONE -1
+
+/// @brief A shapeless recipe: which items must lie in the crafting grid, and what they make.
+/// Crafting once takes one item from every occupied grid slot.
+struct Recipe {
+    std::vector<ItemStack> ingredients;   // Sorted by id; count is the number of grid slots holding the item.
+    ItemStack result;                     // What one craft produces.
+};
+
+/// @brief All recipes, indexed by a hash of their ingredient multiset.
+/// The hash is a sum of one term per distinct ingredient, so it does not depend on
+/// where items lie in the grid and can be updated one slot at a time (see
+/// CraftingPreview). Finding the recipe for a grid is one hash lookup no matter
+/// how many recipes there are. Loaded once at startup from a JSON file of the form
+/// {"recipes": [{"ingredients": {"wood": 1}, "result": {"item": "stick", "count": 4}}, ...]}.
+class RecipeBook {
+private:
+    std::vector<Recipe> recipes;
+    std::unordered_map<uint64_t, int> index;   // Ingredient hash to recipe index.
+
+public:
+    /// @brief Gets the hash term of one distinct ingredient.
+    /// @param id The item.
+    /// @param slots The number of grid slots holding it; 0 contributes nothing.
+    /// @return The term; a multiset's hash is the sum (mod 2^64) of its terms.
+    static uint64_t ingredientHash(ItemId id, int slots);
+
+    /// @brief Adds a recipe.
+    /// @param ingredients The ingredients, in any order; an item may appear more than once.
+    /// @param result What one craft produces.
+    /// @param registry The registry the items must be defined in.
+    /// @param err Receives a description of the problem on failure.
+    /// @return True if the recipe was added.
+    bool addRecipe(std::span<const ItemStack> ingredients, ItemStack result, const ItemRegistry& registry, std::string& err);
+
+    /// @brief Adds every recipe in a JSON recipe file. Items are referred to by name.
+    /// @param json The JSON text.
+    /// @param length The length of the JSON text.
+    /// @param registry The registry to look the item names up in.
+    /// @param err Receives a description of the problem on failure.
+    /// @return True if every recipe was added.
+    bool loadFromJson(const char* json, size_t length, const ItemRegistry& registry, std::string& err);
+
+    /// @brief Adds every recipe in a JSON recipe file on disk.
+    /// @param path The path of the file.
+    /// @param registry The registry to look the item names up in.
+    /// @param err Receives a description of the problem on failure.
+    /// @return True if the file was read and every recipe was added.
+    bool loadFromFile(const std::string& path, const ItemRegistry& registry, std::string& err);
+
+    /// @brief Finds the recipe whose ingredients are exactly a multiset.
+    /// @param hash The multiset's hash.
+    /// @param ingredients The multiset, in any order, each item once.
+    /// @return The recipe index, or RECIPE_NONE.
+    int find(uint64_t hash, std::span<const ItemStack> ingredients) const;
+
+    /// @brief Gets a recipe.
+    /// @param recipeIndex An index returned by find(); must be valid.
+    const Recipe& getRecipe(int recipeIndex) const;
+
+    /// @brief Gets the number of recipes.
+    size_t getCount() const;
+
+    /// @brief Removes every recipe.
+    void clear();
+
+    /// @brief Gets the shared book the game loads its recipes into.
+    /// @return A reference to the singleton RecipeBook.
+    inline static RecipeBook& getInstance() {
+        static RecipeBook instance;
+        return instance;
+    }
+};
+
+/// @brief Tracks which recipe the items in a crafting grid make, as the grid changes.
+/// update() only looks at the slots it is told changed, and a change that does not
+/// replace the item in a slot (only its count) costs nothing.
+class CraftingPreview {
+private:
+    std::array<ItemId, INVENTORY_MAX_SLOTS> slotItems;        // The item in each grid slot at the last update.
+    std::array<ItemStack, INVENTORY_MAX_SLOTS> ingredients;   // Distinct items in the grid; count is the number of slots.
+    int ingredientCount;
+    uint64_t hash;
+    int recipeIndex;
+
+    void changeIngredient(ItemId id, int delta);
+
+public:
+    /// @brief Catches up with changed grid slots and looks the recipe up again if needed.
+    /// Slots that did not change are skipped cheaply, so passing too many is fine.
+    /// @param grid The crafting grid.
+    /// @param changedSlots Bit i is set if slot i may have changed, e.g. grid.getDirtySlots().
+    /// @param book The recipes.
+    void update(const Inventory& grid, uint64_t changedSlots, const RecipeBook& book);
+
+    /// @brief Forgets the grid, as if every slot were empty.
+    void reset();
+
+    /// @brief Gets the recipe the grid makes.
+    /// @return The recipe index in the book, or RECIPE_NONE.
+    int getRecipeIndex() const { return recipeIndex; }
+
+    /// @brief Crafts as many times as possible, up to a limit: takes one item from every
+    /// occupied grid slot per craft and adds the results to an inventory. Only as many
+    /// crafts are done as have all their results fit, so no result is ever lost or split.
+    /// @param grid The crafting grid this preview tracks.
+    /// @param output The inventory the results go to.
+    /// @param times The largest number of crafts.
+    /// @param book The recipes.
+    /// @param registry The registry holding the stack sizes.
+    /// @return The number of crafts done; 0 if the grid makes nothing or the results do not fit.
+    int craft(Inventory& grid, Inventory& output, int times, const RecipeBook& book, const ItemRegistry& registry);
+
+    CraftingPreview();
+};
@@ -1,6 +1,14 @@
 #pragma once
 
+#include <fixed_point.h>
+#include <item_registry.h>
+#include <vec2.h>
+
+#include <array>
+#include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 /// @brief Represent the state of the server.
@@ -48,8 +56,8 @@ typedef struct {
     unsigned char a;  // Alpha component (0-255, transparency)
 } ColorR;
 
-/// @brief Generates a random color.
-/// @note The a value will always be 0 since player's can't be transparent.
+/// @brief Generates a random color from the calling thread's Random.
+/// @note The a value will always be 255 since player's can't be transparent.
 /// @return A PlayerColor with random r, g, and b values.
 PlayerColor generateRandomPlayerColor();
 
@@ -57,26 +65,86 @@ PlayerColor generateRandomPlayerColor();
 /// This is designed to be a 'wrapper' around 
 /// raylib's vector type since including raylib
 /// and networking together in the same file doesn't work.
+/// The simulation itself runs on WorldVec, see applyMovement().
+typedef Vec2<float> EVec;
+
+/// @brief The radius of the circle a player occupies, for drawing and collision.
+#define PLAYER_RADIUS 20.0f
+
+/// @brief Players are kept within +-WORLD_LIMIT on both axes, whatever their clients send.
+#define WORLD_LIMIT 1048576
+
+static_assert(int64_t(WORLD_LIMIT) * 2 * WorldFixed::ONE <= std::numeric_limits<int32_t>::max(),
+              "a position plus a clamped delta must fit in WorldFixed");
+
+/// @brief Clamps a position into +-WORLD_LIMIT. For float, NaN becomes -WORLD_LIMIT.
+template <typename Scalar>
+constexpr Vec2<Scalar> clampToWorld(const Vec2<Scalar>& v) {
+    const Scalar lo = Scalar(-WORLD_LIMIT);
+    const Scalar hi = Scalar(WORLD_LIMIT);
+    Scalar x = v.x > lo ? v.x : lo;
+    Scalar y = v.y > lo ? v.y : lo;
+    return Vec2<Scalar>{x < hi ? x : hi, y < hi ? y : hi};
+}
+
+/// @brief Applies one movement input to a player's position.
+/// The server simulates with Scalar = WorldFixed, and clients predict with the same call,
+/// so both get bit-identical positions on any compiler and CPU. Collision pushes are still
+/// computed in float on the server, so a prediction is only exact while the player touches
+/// nothing.
+/// @param position The position before the input.
+/// @param delta The movement the client sent.
+/// @return The new position, within +-WORLD_LIMIT.
+template <typename Scalar>
+constexpr Vec2<Scalar> applyMovement(const Vec2<Scalar>& position, const Vec2<Scalar>& delta) {
+    // Clamping the delta first keeps the sum far from overflowing a fixed-point Scalar.
+    return clampToWorld(position + clampToWorld(delta));
+}
+
+static_assert(applyMovement(WorldVec{WorldFixed(960), WorldFixed(540)}, toFixed<WorldFixed>(Vec2<float>{0.1f, -1e30f})) ==
+              WorldVec{WorldFixed::fromRaw(960 * 256 + 26), WorldFixed(540 - WORLD_LIMIT)});
+
+/// @brief The largest number of slots an inventory can have (rows * cols).
+/// @note Changed slots are tracked in a 64-bit mask, so this cannot grow past 64.
+#define INVENTORY_MAX_SLOTS 64
+
+/// @brief The contents of one inventory slot.
+/// Everything else about the item lives in its ItemRegistry definition.
 typedef struct {
-    float x;  // x coordinate of the vector
-    float y;  // y coordinate of the vector
-} EVec;
-
-/// @brief Represents an inventory item.
-/// @warning This will be deprecated in future
-/// versions in favor of a class/object instead
-/// of a struct.
-typedef struct {
-    std::string name;      // The name of the item.
-    int maxStackSize;      // The maximum number of items that can be stacked.
-    int amount;            // The current amount of this item in the stack.
-} InventoryItem_s;
+    ItemId id;        // The item in the slot, or ITEM_NONE if the slot is empty.
+    uint16_t count;   // The number of items in the slot; 0 if the slot is empty.
+} ItemStack;
+
+/// @brief Ways of moving items between two slots, see applyInventoryOperation().
+typedef enum {
+    INVENTORY_MOVE = 0,    // Move a whole stack; merges into a stack of the same item, swaps with a different one.
+    INVENTORY_SPLIT = 1,   // Move part of a stack into an empty slot or a stack of the same item.
+    INVENTORY_MERGE = 2,   // Fill the target stack with the same item taken from every slot of the source inventory.
+} InventoryOperation;
+
+/// @brief The outcome of an inventory operation.
+typedef enum {
+    INVENTORY_OK = 0,                  // The operation was applied.
+    INVENTORY_INVALID_SLOT = 1,        // A slot index is out of range, or both slots are the same.
+    INVENTORY_EMPTY_SLOT = 2,          // The slot the items should come from (or merge into) is empty.
+    INVENTORY_INVALID_COUNT = 3,       // The count is zero or more than the stack holds.
+    INVENTORY_NO_ROOM = 4,             // The target slot holds a different item or is full.
+    INVENTORY_NOT_OPEN = 5,            // The container is not open; reported by the server.
+    INVENTORY_INVALID_OPERATION = 6,   // Unknown operation.
+    INVENTORY_NO_RECIPE = 7,           // The crafting grid does not hold the ingredients of any recipe.
+} InventoryResult;
 
 /// @brief Represents the inventory of a player or entity or container.
+/// The slots are stored inline, row by row, so copying an inventory never allocates.
+/// Every change to a slot sets its bit in a dirty mask, which replication uses to
+/// send only the slots that changed.
 class Inventory {
-public:
-    /// @brief A vector containing all items in the inventory.
-    std::vector<InventoryItem_s> items;
+private:
+    /// @brief Every slot, row by row. Only the first rows * cols are used.
+    std::array<ItemStack, INVENTORY_MAX_SLOTS> slots;
+
+    /// @brief Bit i is set when slot i changed since the last clearDirtySlots().
+    uint64_t dirtySlots;
 
     /// @brief The number of rows in the inventory grid.
     int rows;
@@ -84,12 +152,86 @@ public:
     /// @brief The number of columns in the inventory grid.
     int cols;
 
-    /// @brief Constructs an Inventory with a specified number of rows and columns.
+public:
+    /// @brief Gets the number of rows in the inventory grid.
+    int getRows() const { return rows; }
+
+    /// @brief Gets the number of columns in the inventory grid.
+    int getCols() const { return cols; }
+
+    /// @brief Gets the number of slots (rows * cols).
+    int getSlotCount() const { return rows * cols; }
+
+    /// @brief Gets every slot, row by row, without copying them.
+    /// Writes go through setSlot() so that changes are tracked.
+    /// @return A view of the getSlotCount() slots, valid as long as the inventory.
+    std::span<const ItemStack> getSlots() const { return std::span<const ItemStack>(slots.data(), size_t(getSlotCount())); }
+
+    /// @brief Gets the contents of a slot.
+    /// @param index The slot index, row * cols + col; must be below getSlotCount().
+    /// @return The slot's stack.
+    ItemStack getSlot(int index) const { return slots[size_t(index)]; }
+
+    /// @brief Replaces the contents of a slot. A count of 0 or ITEM_NONE empties it.
+    /// @param index The slot index, row * cols + col; must be below getSlotCount().
+    /// @param stack The new contents.
+    void setSlot(int index, ItemStack stack);
+
+    /// @brief Adds items, topping up existing stacks first and then filling empty slots.
+    /// @param id The item to add.
+    /// @param count The number of items to add.
+    /// @param registry The registry holding the item's stack size.
+    /// @return The number of items that did not fit.
+    int add(ItemId id, int count, const ItemRegistry& registry);
+
+    /// @brief Removes items, from the last slot holding them backwards.
+    /// @param id The item to remove.
+    /// @param count The number of items to remove.
+    /// @return The number of items removed.
+    int remove(ItemId id, int count);
+
+    /// @brief Counts the items of one kind across all slots.
+    /// @param id The item to count.
+    /// @return The total number of items.
+    int countOf(ItemId id) const;
+
+    /// @brief Empties every slot.
+    void clear();
+
+    /// @brief Gets the slots that changed since the last clearDirtySlots().
+    /// @return A mask with bit i set if slot i changed.
+    uint64_t getDirtySlots() const { return dirtySlots; }
+
+    /// @brief Forgets which slots changed, e.g. after sending them.
+    void clearDirtySlots() { dirtySlots = 0; }
+
+    /// @brief Marks a slot as changed without changing it, so it is sent again.
+    /// @param index The slot index; must be below getSlotCount().
+    void markSlotDirty(int index) { dirtySlots |= uint64_t(1) << index; }
+
+    /// @brief Constructs an empty Inventory with a specified number of rows and columns.
+    /// Rows beyond INVENTORY_MAX_SLOTS slots are dropped.
     /// @param r The number of rows in the inventory.
     /// @param c The number of columns in the inventory.
-    Inventory(int r, int c) : rows(r), cols(c), items() {}
+    Inventory(int r, int c);
 };
 
+static_assert(INVENTORY_MAX_SLOTS <= 64, "Inventory::dirtySlots has one bit per slot");
+
+/// @brief Moves items between two slots, validating everything before changing anything,
+/// so a failed operation leaves both inventories untouched.
+/// The server applies client requests with it, and clients use it to predict the outcome.
+/// @param operation What to do, see InventoryOperation.
+/// @param from The inventory the items come from.
+/// @param fromSlot The slot the items come from; ignored by INVENTORY_MERGE.
+/// @param to The inventory the items go to; may be the same object as from.
+/// @param toSlot The slot the items go to.
+/// @param count The number of items to move; only used by INVENTORY_SPLIT.
+/// @param registry The registry holding the stack sizes.
+/// @return INVENTORY_OK if the items were moved, otherwise why not.
+InventoryResult applyInventoryOperation(InventoryOperation operation, Inventory& from, int fromSlot, Inventory& to, int toSlot,
+                                        int count, const ItemRegistry& registry);
+
 /// @brief Represents a player entity.
 class PlayerEntity {
 private:
@@ -99,8 +241,8 @@ private:
     /// @brief The color representing the player.
     PlayerColor color;
 
-    /// @brief The current position of the player in the game world.
-    EVec pos;
+    /// @brief The current position of the player in the game world, in simulation units.
+    WorldVec pos;
 
     /// @brief The current health of the player.
     float health;
@@ -110,8 +252,8 @@ private:
 
 public:
     /// @brief Gets the player's name.
-    /// @return The name of the player as a std::string.
-    std::string getName() const;
+    /// @return A view of the name, valid until the player is destroyed.
+    std::string_view getName() const;
 
     /// @brief Gets the player's name as a C-style string.
     /// @return The name of the player as a const char*.
@@ -142,11 +284,17 @@ public:
     void setHealth(float health);
 
     /// @brief Gets the player's inventory.
-    /// @return The current inventory of the player as Inventory.
-    Inventory getInventory();
+    /// @return A reference to the player's inventory.
+    const Inventory& getInventory() const;
+
+    /// @brief Gets the player's inventory for changing it.
+    /// @return A reference to the player's inventory.
+    Inventory& getInventory();
 
-    /// @brief Moves the player by a given vector.
-    /// @param vec The vector by which to move the player.
+    /// @brief Moves the player about a tenth of the way towards a position, in fixed point so
+    /// every machine ends up at the same spot. The factor is WorldFixed(0.1f), which is exactly
+    /// 26/256 = 0.1015625. Once a step would round to nothing, the player snaps to the position.
+    /// @param vec The position to move towards.
     void move(const EVec& vec);
     
     /// @brief Damages the player by a given amount.
@@ -155,15 +303,14 @@ public:
     bool takeDamage(float amount);
     
     /// @brief Constructs a PlayerEntity.
-    /// @param name The name of the player.
+    /// @param name The name of the player; pass a temporary or std::move it to avoid a copy.
     /// @param color The color of the player.
     /// @param pos The world position of the player.
     /// @param health The health of the player.
-    PlayerEntity(std::string name, PlayerColor color, EVec pos, float health, Inventory inventory) : name(name), color(color), pos(pos), health(health), inventory(std::move(inventory)) {};
+    /// @param inventory The player's starting inventory.
+    PlayerEntity(std::string name, PlayerColor color, EVec pos, float health, const Inventory& inventory) : name(std::move(name)), color(color), pos(toFixed<WorldFixed>(pos)), health(health), inventory(inventory) {};
 };
 
-EVec Lerp(const EVec& start, const EVec& end, float t);
-
 //class Client {
 //private:
 //    Client() {}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <vec2.h>
+
+#include <compare>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+/// @brief A signed fixed-point number with FractionBits bits after the binary point, in 32 bits.
+///
+/// Every operation is integer arithmetic, so results are the same on every compiler,
+/// optimization level and CPU, unlike float where contraction into FMAs or x87 precision
+/// can change the last bits. Use it where the client and the server must compute exactly
+/// the same thing. Overflow wraps around instead of being undefined; division by zero is
+/// undefined, as for int.
+template <int FractionBits>
+class FixedPoint {
+    static_assert(FractionBits > 0 && FractionBits < 31, "FixedPoint needs 1 to 30 fraction bits");
+
+private:
+    int32_t raw;
+
+public:
+    /// @brief The raw value of 1.
+    static constexpr int32_t ONE = int32_t(1) << FractionBits;
+
+    /// @brief Creates a number from its raw representation, value * ONE.
+    static constexpr FixedPoint fromRaw(int32_t raw) {
+        FixedPoint result;
+        result.raw = raw;
+        return result;
+    }
+
+    /// @brief Gets the raw representation, value * ONE.
+    constexpr int32_t getRaw() const {
+        return raw;
+    }
+
+    /// @brief Converts to float. Exact while the value needs at most 24 significant bits.
+    constexpr float toFloat() const {
+        return float(raw) / float(ONE);
+    }
+
+    /// @brief Converts to int, rounding towards negative infinity.
+    constexpr int toInt() const {
+        return raw >> FractionBits;
+    }
+
+    friend constexpr FixedPoint operator+(FixedPoint a, FixedPoint b) {
+        return fromRaw(int32_t(uint32_t(a.raw) + uint32_t(b.raw)));
+    }
+
+    friend constexpr FixedPoint operator-(FixedPoint a, FixedPoint b) {
+        return fromRaw(int32_t(uint32_t(a.raw) - uint32_t(b.raw)));
+    }
+
+    friend constexpr FixedPoint operator-(FixedPoint a) {
+        return fromRaw(int32_t(0u - uint32_t(a.raw)));
+    }
+
+    /// @brief Multiplies, rounding towards negative infinity.
+    friend constexpr FixedPoint operator*(FixedPoint a, FixedPoint b) {
+        return fromRaw(int32_t((int64_t(a.raw) * int64_t(b.raw)) >> FractionBits));
+    }
+
+    /// @brief Divides, rounding towards zero.
+    friend constexpr FixedPoint operator/(FixedPoint a, FixedPoint b) {
+        return fromRaw(int32_t(int64_t(uint64_t(int64_t(a.raw)) << FractionBits) / int64_t(b.raw)));
+    }
+
+    constexpr FixedPoint& operator+=(FixedPoint other) {
+        return *this = *this + other;
+    }
+
+    constexpr FixedPoint& operator-=(FixedPoint other) {
+        return *this = *this - other;
+    }
+
+    constexpr FixedPoint& operator*=(FixedPoint other) {
+        return *this = *this * other;
+    }
+
+    constexpr FixedPoint& operator/=(FixedPoint other) {
+        return *this = *this / other;
+    }
+
+    friend constexpr bool operator==(FixedPoint a, FixedPoint b) = default;
+    friend constexpr auto operator<=>(FixedPoint a, FixedPoint b) = default;
+
+    /// @brief Constructs zero.
+    constexpr FixedPoint() : raw(0) {}
+
+    /// @brief Constructs an integer value.
+    constexpr FixedPoint(int value) : raw(int32_t(uint32_t(value) << FractionBits)) {}
+
+    /// @brief Converts from float, rounding to the nearest representable value.
+    /// Only here should floats enter the simulation, e.g. from input or config, so values
+    /// out of range saturate and NaN becomes 0 instead of being undefined.
+    explicit constexpr FixedPoint(float value) : raw(roundFloat(value)) {}
+
+private:
+    static constexpr int32_t roundFloat(float value) {
+        double scaled = double(value) * ONE;
+        if (scaled != scaled) {
+            return 0;
+        }
+        if (scaled >= double(std::numeric_limits<int32_t>::max())) {
+            return std::numeric_limits<int32_t>::max();
+        }
+        if (scaled <= double(std::numeric_limits<int32_t>::min())) {
+            return std::numeric_limits<int32_t>::min();
+        }
+        return int32_t(int64_t(scaled + (value < 0.0f ? -0.5 : 0.5)));
+    }
+};
+
+/// @brief Q16.16: a range of +-32768 with a resolution of 1/65536, for values near the origin.
+typedef FixedPoint<16> Fixed;
+
+/// @brief A vector of Fixed.
+typedef Vec2<Fixed> FixedVec;
+
+/// @brief Q24.8: a range of +-8388608 with a resolution of 1/256, for positions anywhere in
+/// the world. Player movement is simulated in it, see applyMovement().
+typedef FixedPoint<8> WorldFixed;
+
+/// @brief A position or movement in the deterministic simulation.
+typedef Vec2<WorldFixed> WorldVec;
+
+/// @brief Converts a float vector, rounding each component to the nearest FixedType.
+template <typename FixedType = Fixed>
+constexpr Vec2<FixedType> toFixed(const Vec2<float>& v) {
+    return Vec2<FixedType>{FixedType(v.x), FixedType(v.y)};
+}
+
+/// @brief Converts to a float vector, e.g. for drawing or the wire.
+/// Exact while a component needs at most 24 significant bits, e.g. WorldVec within +-65536.
+template <int FractionBits>
+constexpr Vec2<float> toFloat(const Vec2<FixedPoint<FractionBits>>& v) {
+    return Vec2<float>{v.x.toFloat(), v.y.toFloat()};
+}
+
+/// @brief Hashes simulation state (FNV-1a over the raw values), so the client and the server
+/// can compare one number per tick to detect a desync instead of the whole state.
+template <int FractionBits>
+constexpr uint64_t hashState(std::span<const Vec2<FixedPoint<FractionBits>>> positions) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (const Vec2<FixedPoint<FractionBits>>& position : positions) {
+        for (int32_t raw : {position.x.getRaw(), position.y.getRaw()}) {
+            for (int byte = 0; byte < 4; ++byte) {
+                hash = (hash ^ ((uint32_t(raw) >> (byte * 8)) & 0xFF)) * 0x100000001B3ull;
+            }
+        }
+    }
+    return hash;
+}
+
+// The arithmetic is constexpr, so its exact results are checked by every build.
+static_assert((Fixed(3) / Fixed(2)).getRaw() == Fixed::ONE * 3 / 2);
+static_assert((Fixed(-3) * Fixed(0.5f)).getRaw() == -Fixed::ONE * 3 / 2);
+static_assert(Fixed(0.1f).getRaw() == 6554);
+static_assert(Fixed(std::numeric_limits<float>::quiet_NaN()).getRaw() == 0);
+static_assert(WorldFixed(1e30f).getRaw() == std::numeric_limits<int32_t>::max());
+static_assert(Lerp(FixedVec{Fixed(0), Fixed(100)}, FixedVec{Fixed(10), Fixed(0)}, Fixed(0.25f)) == FixedVec{Fixed(2.5f), Fixed(75)});
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Path (relative to the executable) of the item definitions shipped in assets/.
+#define ITEM_REGISTRY_PATH "assets/items.json"
+
+/// @brief The id of an empty slot; never assigned to an item.
+#define ITEM_NONE 0
+
+/// @brief Identifies an item definition. Ids are assigned in the item file and never reused,
+/// so they can be saved to disk and sent over the network.
+typedef uint16_t ItemId;
+
+/// @brief Everything that is the same for every stack of an item.
+typedef struct {
+    std::string name;        // Unique name, e.g. "wood".
+    uint16_t maxStackSize;   // The maximum number of items in one slot; 0 for ids with no item.
+} ItemDefinition;
+
+/// @brief Maps item ids to their definitions and names to ids.
+/// Loaded once at startup from a JSON file of the form
+/// {"items": [{"id": 1, "name": "wood", "maxStackSize": 64}, ...]}.
+/// Lookups by id are an array index.
+class ItemRegistry {
+private:
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+
+    std::vector<ItemDefinition> definitions;                                 // Indexed by id.
+    std::unordered_map<std::string, ItemId, NameHash, std::equal_to<>> ids;  // Name to id.
+
+public:
+    /// @brief Adds an item definition.
+    /// @param id The item's id; must not be ITEM_NONE or already in use.
+    /// @param name The item's name; must not be empty or already in use.
+    /// @param maxStackSize The maximum number of items in one slot; at least 1.
+    /// @param err Receives a description of the problem on failure.
+    /// @return True if the item was added.
+    bool registerItem(ItemId id, std::string_view name, uint16_t maxStackSize, std::string& err);
+
+    /// @brief Adds every item in a JSON item file.
+    /// @param json The JSON text.
+    /// @param length The length of the JSON text.
+    /// @param err Receives a description of the problem on failure.
+    /// @return True if every item was added.
+    bool loadFromJson(const char* json, size_t length, std::string& err);
+
+    /// @brief Adds every item in a JSON item file on disk.
+    /// @param path The path of the file.
+    /// @param err Receives a description of the problem on failure.
+    /// @return True if the file was read and every item was added.
+    bool loadFromFile(const std::string& path, std::string& err);
+
+    /// @brief Removes every item definition.
+    void clear();
+
+    /// @brief Checks whether an id belongs to an item.
+    /// @param id The id to check.
+    /// @return True if the id has a definition.
+    bool isValid(ItemId id) const {
+        return id < definitions.size() && definitions[id].maxStackSize != 0;
+    }
+
+    /// @brief Gets the maximum number of items of a kind in one slot.
+    /// @param id The item's id.
+    /// @return The maximum stack size, or 0 if the id has no definition.
+    uint16_t getMaxStackSize(ItemId id) const {
+        return id < definitions.size() ? definitions[id].maxStackSize : 0;
+    }
+
+    /// @brief Gets the name of an item.
+    /// @param id The item's id.
+    /// @return The item's name, or an empty view if the id has no definition.
+    std::string_view getName(ItemId id) const;
+
+    /// @brief Looks up an item by name.
+    /// @param name The item's name.
+    /// @return The item's id, or ITEM_NONE if no item has that name.
+    ItemId findId(std::string_view name) const;
+
+    /// @brief Gets the number of item definitions.
+    size_t getCount() const;
+
+    /// @brief Gets the shared registry the game loads its items into.
+    /// @return A reference to the singleton ItemRegistry.
+    inline static ItemRegistry& getInstance() {
+        static ItemRegistry instance;
+        return instance;
+    }
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <picojson.h>
+
+/// @brief Gets a field of a JSON object without inserting it, unlike picojson's operator[].
+/// @param obj The object.
+/// @param key The name of the field.
+/// @return The field's value, or a null value if the object has no such field.
+inline const picojson::value& getJsonField(const picojson::object& obj, const char* key) {
+    static const picojson::value missing;
+    auto it = obj.find(key);
+    return it != obj.end() ? it->second : missing;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+// wingdi.h (pulled in by windows.h/winsock2.h) defines ERROR as a macro.
+#if defined(_WIN32) && defined(ERROR)
+#undef ERROR
+#endif
+
+/// @brief Defines various log levels for game logging.
+typedef enum {
+    DEBUG = 0,       // Debugging information.
+    INFO = 10,       // Informational messages.
+    WARNING = 20,    // Warnings about potential issues.
+    ERROR = 30,      // Error messages.
+    CRITICAL = 40,   // Critical issues that may halt the game.
+} LogLevel;
+
+/// @brief Lowest level whose log macros are compiled in.
+/// Defaults to INFO in release (NDEBUG) builds so GAME_LOG_DEBUG calls and their
+/// arguments disappear entirely, and to DEBUG otherwise.
+#ifndef LOG_COMPILE_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_COMPILE_MIN_LEVEL 10
+#else
+#define LOG_COMPILE_MIN_LEVEL 0
+#endif
+#endif
+
+/// @brief Maximum length of a single log message; longer messages are truncated.
+#define LOG_MESSAGE_CAPACITY 240
+
+/// @brief Number of records the ring buffer holds. Must be a power of two.
+#define LOG_RING_CAPACITY 4096
+
+/// @brief Logs a printf-style message through the shared logger.
+/// The level check happens before any formatting, and levels below
+/// LOG_COMPILE_MIN_LEVEL are removed at compile time.
+#define GAME_LOG(level, ...)                                                    \
+    do {                                                                        \
+        if constexpr ((level) >= LOG_COMPILE_MIN_LEVEL) {                       \
+            GameLogger& gameLoggerInstance_ = GameLogger::getInstance();        \
+            if (gameLoggerInstance_.isEnabled(level)) {                         \
+                gameLoggerInstance_.Logf((level), __VA_ARGS__);                 \
+            }                                                                   \
+        }                                                                       \
+    } while (0)
+
+#define GAME_LOG_DEBUG(...) GAME_LOG(DEBUG, __VA_ARGS__)
+#define GAME_LOG_INFO(...) GAME_LOG(INFO, __VA_ARGS__)
+#define GAME_LOG_WARNING(...) GAME_LOG(WARNING, __VA_ARGS__)
+#define GAME_LOG_ERROR(...) GAME_LOG(ERROR, __VA_ARGS__)
+#define GAME_LOG_CRITICAL(...) GAME_LOG(CRITICAL, __VA_ARGS__)
+
+/// @brief Provides logging functionalities for the game, shared by client and server.
+/// Log calls format the message straight into a slot of a lock-free ring buffer
+/// and return; a background thread writes the records to stderr. When the ring
+/// is full, records are dropped (and counted) rather than blocking the caller.
+class GameLogger {
+private:
+    /// @brief A formatted log message waiting to be written.
+    struct Record {
+        LogLevel level;                       // The level of the message.
+        uint16_t length;                      // Length of message, excluding the null terminator.
+        int64_t timestamp;                    // Wall clock time in nanoseconds since the epoch.
+        char message[LOG_MESSAGE_CAPACITY];   // The null-terminated message.
+    };
+
+    /// @brief A ring buffer slot. sequence tells producers and the consumer whose turn it is.
+    struct Cell {
+        std::atomic<uint64_t> sequence;
+        Record record;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    alignas(64) std::atomic<uint64_t> enqueuePos;  // Next slot producers claim.
+    alignas(64) std::atomic<uint64_t> dequeuePos;  // Next slot the flusher reads (written by the flusher only).
+    alignas(64) std::atomic<uint64_t> droppedRecords;
+    std::atomic<int> minimumLevel;
+    std::atomic<LogLevel> logLevel;                // Level used by Log(msg) without an explicit level.
+    std::atomic<bool> stopping;
+    std::thread flusher;
+
+    Cell* claim(uint64_t& pos);
+    void publish(Cell* cell, uint64_t pos);
+    size_t drain();
+    void flusherLoop();
+
+public:
+    /// @brief Gets the current logging level used by Log(msg).
+    /// @return The current LogLevel.
+    LogLevel getLogLevel();
+
+    /// @brief Sets the logging level used by Log(msg).
+    /// @param level The LogLevel to set.
+    void setLogLevel(LogLevel level);
+
+    /// @brief Gets the lowest level that is logged.
+    /// @return The minimum LogLevel.
+    LogLevel getMinimumLevel() const;
+
+    /// @brief Sets the lowest level that is logged; anything below is discarded before formatting.
+    /// @param level The minimum LogLevel.
+    void setMinimumLevel(LogLevel level);
+
+    /// @brief Checks whether messages of a level would be logged.
+    /// @param level The level to check.
+    /// @return True if the level is at or above the minimum level.
+    bool isEnabled(LogLevel level) const {
+        return int(level) >= minimumLevel.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Logs a message with the current logging level.
+    /// @param msg The message to log.
+    void Log(std::string_view msg);
+
+    /// @brief Logs a message with a specific logging level.
+    /// @param level The LogLevel for the message.
+    /// @param msg The message to log.
+    void Log(LogLevel level, std::string_view msg);
+
+    /// @brief Logs a printf-style message with a specific logging level.
+    /// @param level The LogLevel for the message.
+    /// @param format The printf format string.
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((format(printf, 3, 4)))
+#endif
+    void Logf(LogLevel level, const char* format, ...);
+
+    /// @brief Writes every queued record before returning.
+    /// @note Called automatically for CRITICAL messages and on destruction.
+    void flush();
+
+    /// @brief Gets the number of records dropped because the ring buffer was full.
+    /// @return The total number of dropped records.
+    uint64_t getDroppedCount() const;
+
+    /// @brief Gets the shared logger instance, starting its flusher thread on first use.
+    /// @return A reference to the singleton GameLogger.
+    inline static GameLogger& getInstance() {
+        static GameLogger instance;
+        return instance;
+    }
+
+    GameLogger();
+    ~GameLogger();
+
+    GameLogger(const GameLogger&) = delete;
+    GameLogger& operator=(const GameLogger&) = delete;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/// @brief A read-only memory mapping of a whole file.
+/// The mapping is released when the object is destroyed.
+class MappedFile {
+private:
+    const unsigned char* mappedData;  // Start of the mapping, nullptr when nothing is mapped.
+    size_t mappedSize;                // Size of the mapping in bytes.
+#ifdef _WIN32
+    void* fileHandle;                 // HANDLE of the opened file.
+    void* mappingHandle;              // HANDLE of the file mapping object.
+#endif
+
+public:
+    /// @brief Opens and maps a file.
+    /// @param filePath The path of the file to map.
+    /// @return True if the whole file is now mapped, false otherwise.
+    bool open(const std::string& filePath);
+
+    /// @brief Releases the mapping, if any.
+    void close();
+
+    /// @brief Checks whether a file is currently mapped.
+    /// @return True if a file is mapped.
+    bool isOpen() const;
+
+    /// @brief Gets the mapped bytes.
+    /// @return A pointer to the start of the file, or nullptr.
+    const unsigned char* data() const;
+
+    /// @brief Gets the size of the mapped file.
+    /// @return The size of the file in bytes.
+    size_t size() const;
+
+    MappedFile() noexcept;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
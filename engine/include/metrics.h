@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// @brief The kind of a metric family, as named in the Prometheus exposition format.
+typedef enum {
+    METRIC_COUNTER,     // Monotonically increasing value.
+    METRIC_GAUGE,       // Value that can go up and down.
+    METRIC_HISTOGRAM,   // Distribution of observations in fixed buckets.
+} MetricType;
+
+/// @brief A monotonically increasing count.
+class Counter {
+private:
+    std::atomic<uint64_t> value{0};
+
+public:
+    /// @brief Adds to the counter.
+    /// @param amount The amount to add.
+    void increment(uint64_t amount = 1) {
+        value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    /// @brief Gets the current count.
+    uint64_t get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+};
+
+/// @brief A value that is set to the latest sample.
+class Gauge {
+private:
+    std::atomic<double> value{0.0};
+
+public:
+    /// @brief Sets the gauge.
+    /// @param sample The new value.
+    void set(double sample) {
+        value.store(sample, std::memory_order_relaxed);
+    }
+
+    /// @brief Adds to the gauge.
+    /// @param amount The amount to add, may be negative.
+    void add(double amount) {
+        value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    /// @brief Gets the current value.
+    double get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+};
+
+/// @brief Counts observations into buckets with fixed upper bounds.
+class Histogram {
+private:
+    std::vector<double> bounds;                       // Ascending bucket upper bounds, +Inf is implicit.
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets; // Per-bucket counts, one more than bounds.
+    std::atomic<double> sum{0.0};
+    std::atomic<uint64_t> count{0};
+
+public:
+    /// @brief Records one observation.
+    /// @param sample The observed value.
+    void observe(double sample);
+
+    /// @brief Gets the bucket upper bounds.
+    const std::vector<double>& getBounds() const {
+        return bounds;
+    }
+
+    /// @brief Gets the number of observations in one bucket (not cumulative).
+    /// @param index Bucket index; getBounds().size() is the +Inf bucket.
+    uint64_t getBucketCount(size_t index) const {
+        return buckets[index].load(std::memory_order_relaxed);
+    }
+
+    /// @brief Gets the sum of every observation.
+    double getSum() const {
+        return sum.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Gets the number of observations.
+    uint64_t getCount() const {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    explicit Histogram(std::vector<double> bounds);
+};
+
+/// @brief Owns named metrics and renders them in the Prometheus text exposition format.
+/// Looking a metric up takes a lock, so keep the returned reference and update
+/// it directly on hot paths; updates are lock free. References stay valid until
+/// the metric is removed.
+class MetricsRegistry {
+private:
+    /// @brief Every metric sharing a name, keyed by their label set.
+    struct Family {
+        MetricType type;
+        std::string help;
+        std::vector<double> bounds;   // Histogram families only.
+        std::map<std::string, std::unique_ptr<Counter>> counters;
+        std::map<std::string, std::unique_ptr<Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    };
+
+    mutable std::mutex mutex;
+    std::map<std::string, Family> families;
+
+    Family& getFamily(const std::string& name, MetricType type, const std::string& help);
+
+public:
+    /// @brief Gets or creates a counter.
+    /// @param name Metric name, e.g. "server_ticks_total".
+    /// @param help One line description.
+    /// @param labels Label set without braces, e.g. "peer=\"3\"", or empty.
+    /// @return The counter.
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /// @brief Gets or creates a gauge.
+    /// @param name Metric name.
+    /// @param help One line description.
+    /// @param labels Label set without braces, or empty.
+    /// @return The gauge.
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /// @brief Gets or creates a histogram. Every histogram of a family shares the bounds of the first one.
+    /// @param name Metric name.
+    /// @param help One line description.
+    /// @param bounds Ascending bucket upper bounds.
+    /// @param labels Label set without braces, or empty.
+    /// @return The histogram.
+    Histogram& histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds,
+                         const std::string& labels = "");
+
+    /// @brief Removes every metric with the given label set, e.g. the metrics of a disconnected peer.
+    /// @param labels The label set to remove.
+    void removeLabels(const std::string& labels);
+
+    /// @brief Renders every metric in the Prometheus text exposition format.
+    /// @return The rendered text.
+    std::string renderPrometheus() const;
+
+    /// @brief Writes renderPrometheus() to a file, replacing it atomically.
+    /// @param path The file to write.
+    /// @return True if the file was written.
+    bool writeToFile(const std::string& path) const;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// @brief Number of zones each thread keeps. Must be a power of two; older zones are overwritten.
+#define PROFILER_THREAD_CAPACITY 65536
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+
+/// @brief Times the rest of the enclosing scope as a zone called name.
+/// name must outlive the profiler, so pass a string literal.
+/// Compiles to nothing unless ENABLE_PROFILING is defined.
+#ifdef ENABLE_PROFILING
+#define PROFILE_ZONE(name) ProfileZone PROFILER_CONCAT(profileZone_, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name)
+#endif
+
+/// @brief Times the rest of the enclosing function as a zone named after it.
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+
+/// @brief Collects timed zones from every thread and exports them as a Chrome trace.
+/// Each thread records into its own ring buffer, so recording a zone takes no
+/// locks; the lock is only taken the first time a thread records and on export.
+class Profiler {
+public:
+    /// @brief A finished zone.
+    struct Zone {
+        const char* name;    // Static name passed to PROFILE_ZONE.
+        uint64_t start;      // Start time in nanoseconds since the profiler was created.
+        uint64_t duration;   // Duration in nanoseconds.
+    };
+
+private:
+    /// @brief The zones recorded by one thread.
+    struct ThreadBuffer {
+        uint32_t threadId;             // Small sequential id used as the trace tid.
+        std::unique_ptr<Zone[]> zones;
+        std::atomic<uint64_t> head;    // Total zones recorded; only the owning thread writes it.
+    };
+
+    std::chrono::steady_clock::time_point epoch;
+    std::atomic<bool> enabled;
+    std::mutex buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;   // Kept until exit, so zones of finished threads still export.
+
+    ThreadBuffer* registerThread();
+
+public:
+    /// @brief Gets the current time on the profiler clock.
+    /// @return Nanoseconds since the profiler was created.
+    uint64_t now() const {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    /// @brief Records a finished zone for the calling thread.
+    /// @param name Static zone name.
+    /// @param start Start time from now().
+    /// @param end End time from now().
+    void record(const char* name, uint64_t start, uint64_t end);
+
+    /// @brief Turns recording on or off at runtime. Recording is on by default.
+    /// @param enable Whether zones are recorded.
+    void setEnabled(bool enable);
+
+    /// @brief Checks whether zones are recorded.
+    /// @return True if recording is on.
+    bool isEnabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Writes the zones every thread still holds as Chrome trace JSON (also read by Perfetto).
+    /// @note Zones a thread records during the export may be torn if its ring wraps at the same time.
+    /// @param path The file to write.
+    /// @return True if the file was written.
+    bool writeChromeTrace(const char* path);
+
+    /// @brief Gets the shared profiler instance.
+    /// @return A reference to the singleton Profiler.
+    inline static Profiler& getInstance() {
+        static Profiler instance;
+        return instance;
+    }
+
+    Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+};
+
+/// @brief Scope guard that records a zone from its construction to its destruction.
+class ProfileZone {
+private:
+    const char* name;
+    uint64_t start;
+
+public:
+    explicit ProfileZone(const char* name) : name(name), start(Profiler::getInstance().now()) {}
+
+    ~ProfileZone() {
+        Profiler& profiler = Profiler::getInstance();
+        profiler.record(name, start, profiler.now());
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+/// @brief A token bucket: allows bursts of up to burst actions, refilled at ratePerSecond.
+/// The rate and burst are passed on every call instead of stored, so a bucket is
+/// 8 bytes and large tables of them (one per address or player) stay small.
+/// Times are in milliseconds from any wrapping 32-bit clock, such as enet_time_get().
+class TokenBucket {
+private:
+    float tokens;
+    uint32_t lastRefillMs;
+
+    void refill(uint32_t nowMs, float ratePerSecond, float burst);
+
+public:
+    /// @brief Takes tokens if enough are available.
+    /// @param nowMs The current time in milliseconds.
+    /// @param ratePerSecond Tokens added per second.
+    /// @param burst Maximum number of tokens the bucket holds.
+    /// @param cost Tokens this action needs.
+    /// @return True if the action is allowed (and the tokens were taken).
+    bool take(uint32_t nowMs, float ratePerSecond, float burst, float cost = 1.0f);
+
+    /// @brief Checks whether the bucket has refilled completely, i.e. has been idle.
+    /// @param nowMs The current time in milliseconds.
+    /// @param ratePerSecond Tokens added per second.
+    /// @param burst Maximum number of tokens the bucket holds.
+    /// @return True if a full burst is available.
+    bool isFull(uint32_t nowMs, float ratePerSecond, float burst) const;
+
+    /// @brief Creates a full bucket.
+    /// @param nowMs The current time in milliseconds.
+    /// @param burst Maximum number of tokens the bucket holds.
+    TokenBucket(uint32_t nowMs, float burst) : tokens(burst), lastRefillMs(nowMs) {}
+};
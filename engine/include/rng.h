@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+
+/// @brief A fast pseudo-random generator (xoshiro256**): 32 bytes of state, a few cycles
+/// per number and the same sequence on every platform for the same seed, unlike the
+/// std:: distributions. Not for anything security related.
+///
+/// Gameplay code uses the calling thread's stream from getThreadLocal(), which needs no
+/// locking. Tests and replays seed it with seedThreadLocal() to get the same numbers again.
+/// It also meets UniformRandomBitGenerator, so it works with <random> and std::shuffle.
+class Random {
+private:
+    uint64_t state[4];
+
+public:
+    typedef uint64_t result_type;
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    /// @brief Gets the next 64 random bits.
+    uint64_t next();
+
+    /// @brief Same as next(), for UniformRandomBitGenerator.
+    result_type operator()() {
+        return next();
+    }
+
+    /// @brief Gets a uniform integer in [0, bound), without modulo bias.
+    /// @param bound The exclusive upper limit; 0 gives 0.
+    uint32_t nextBelow(uint32_t bound);
+
+    /// @brief Gets a uniform integer in [min, max].
+    int nextInt(int min, int max);
+
+    /// @brief Gets a uniform float in [0, 1).
+    float nextFloat();
+
+    /// @brief Gets a uniform double in [0, 1).
+    double nextDouble();
+
+    /// @brief Fills a buffer with random bits.
+    void fill(std::span<uint64_t> out);
+
+    /// @brief Fills a buffer with uniform floats in [min, max).
+    void fillFloats(std::span<float> out, float min = 0.0f, float max = 1.0f);
+
+    /// @brief Advances the generator by 2^128 numbers. Streams made by copying a
+    /// generator and jumping the copy never overlap, which makes independent substreams.
+    void jump();
+
+    /// @brief Gets the calling thread's generator. The first call on a thread seeds it from
+    /// std::random_device, unless seedThreadLocal() was called on that thread before.
+    static Random& getThreadLocal();
+
+    /// @brief Reseeds the calling thread's generator, to reproduce a run.
+    /// @param seed Any value; equal seeds give equal sequences.
+    static void seedThreadLocal(uint64_t seed);
+
+    /// @brief Constructs a generator.
+    /// @param seed Any value, spread over the whole state with splitmix64.
+    explicit Random(uint64_t seed);
+};
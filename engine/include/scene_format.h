@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// @brief Magic number at the start of every compiled scene file ("DSCN" in little-endian).
+#define SCENE_BINARY_MAGIC 0x4E435344u
+
+/// @brief Current version of the compiled scene format.
+/// @note Bump this whenever the layout of any record below changes.
+#define SCENE_BINARY_VERSION 1
+
+/// @brief File extension used for compiled scenes, next to their JSON source.
+#define SCENE_BINARY_EXTENSION ".scene"
+
+/// @brief Header of a compiled scene file.
+/// All offsets are in bytes from the start of the file and are 4-byte aligned,
+/// so the sections can be read in place from a memory mapped file.
+/// @note Multi-byte fields are stored in the native (little-endian) byte order.
+typedef struct {
+    uint32_t magic;              // Always SCENE_BINARY_MAGIC.
+    uint16_t version;            // Always SCENE_BINARY_VERSION.
+    uint16_t headerSize;         // sizeof(SceneBinaryHeader) at the time of writing.
+    uint32_t fileSize;           // Total size of the file in bytes.
+    uint32_t stringTableOffset;  // Offset of the string table.
+    uint32_t stringTableSize;    // Size of the string table in bytes.
+    uint32_t textEntityOffset;   // Offset of the packed SceneBinaryTextEntity array.
+    uint32_t textEntityCount;    // Number of SceneBinaryTextEntity records.
+} SceneBinaryHeader;
+
+/// @brief A TextEntity record in a compiled scene.
+typedef struct {
+    float x;              // x position of the text.
+    float y;              // y position of the text.
+    uint32_t textOffset;  // Offset of the null-terminated text inside the string table.
+    uint32_t textLength;  // Length of the text, excluding the null terminator.
+    unsigned char r;      // Red component (0-255)
+    unsigned char g;      // Green component (0-255)
+    unsigned char b;      // Blue component (0-255)
+    unsigned char a;      // Alpha component (0-255, transparency)
+} SceneBinaryTextEntity;
+
+static_assert(sizeof(SceneBinaryHeader) == 28, "SceneBinaryHeader layout changed, bump SCENE_BINARY_VERSION");
+static_assert(sizeof(SceneBinaryTextEntity) == 20, "SceneBinaryTextEntity layout changed, bump SCENE_BINARY_VERSION");
+
+/// @brief Validates a compiled scene held in memory.
+/// Checks the magic, version and that every section and string lies inside the buffer.
+/// @param data The start of the compiled scene.
+/// @param size The size of the buffer in bytes.
+/// @return The header if the scene is valid, nullptr otherwise.
+const SceneBinaryHeader* validateSceneBinary(const unsigned char* data, size_t size);
+
+/// @brief Compiles a JSON scene into the binary scene format.
+/// Entities of unknown types are skipped with a warning.
+/// @param json The JSON text of the scene.
+/// @param length The length of the JSON text.
+/// @param out Receives the compiled scene.
+/// @param err Receives a description of the problem on failure.
+/// @return True on success, false if the JSON is not a valid scene.
+bool compileScene(const char* json, size_t length, std::vector<unsigned char>& out, std::string& err);
+
+/// @brief Gets the packed TextEntity records of a validated compiled scene.
+/// @param data The start of the compiled scene.
+/// @param header The header returned by validateSceneBinary.
+/// @return A pointer to header->textEntityCount records.
+inline const SceneBinaryTextEntity* getSceneBinaryTextEntities(const unsigned char* data, const SceneBinaryHeader* header) {
+    return reinterpret_cast<const SceneBinaryTextEntity*>(data + header->textEntityOffset);
+}
+
+/// @brief Gets the string table of a validated compiled scene.
+/// @param data The start of the compiled scene.
+/// @param header The header returned by validateSceneBinary.
+/// @return A pointer to the first byte of the string table.
+inline const char* getSceneBinaryStrings(const unsigned char* data, const SceneBinaryHeader* header) {
+    return reinterpret_cast<const char*>(data + header->stringTableOffset);
+}
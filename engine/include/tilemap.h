@@ -0,0 +1,146 @@
+#pragma once
+
+#include <engine.h>
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Identifies a kind of tile.
+typedef uint16_t TileId;
+
+/// @brief The tiles the world generator places. TILE_AIR is also what unloaded chunks read as.
+#define TILE_AIR 0
+#define TILE_GRASS 1
+#define TILE_STONE 2
+#define TILE_WATER 3
+
+/// @brief The side of a tile, in world units.
+#define TILE_SIZE 32.0f
+
+/// @brief The side of a chunk, in tiles.
+#define CHUNK_SIZE 32
+#define CHUNK_TILE_COUNT (CHUNK_SIZE * CHUNK_SIZE)
+
+/// @brief The position of a chunk; chunk (0, 0) holds the tiles from (0, 0) to (CHUNK_SIZE - 1, CHUNK_SIZE - 1).
+typedef struct {
+    int32_t x;
+    int32_t y;
+} ChunkCoord;
+
+/// @brief A run of equal tiles in an encoded chunk, in row-major order.
+typedef struct {
+    uint16_t length;  // The number of tiles, 1 to CHUNK_TILE_COUNT.
+    TileId tile;      // The tile repeated.
+} TileRun;
+
+/// @brief Gets the chunk holding a world position.
+ChunkCoord chunkCoordAt(EVec position);
+
+/// @brief Gets the chunk holding a tile.
+ChunkCoord chunkCoordOfTile(int32_t tileX, int32_t tileY);
+
+/// @brief Packs a chunk position into a map key.
+uint64_t chunkKey(ChunkCoord coord);
+
+/// @brief The tiles of one chunk, palette compressed.
+/// Each tile is stored as an index into the list of distinct tiles in the chunk, using as
+/// few bits as that list needs (0, 1, 2, 4, 8 or 16): a chunk of one tile takes no index
+/// memory at all, and the typical handful of tiles takes 2 bits per tile instead of 16.
+class Chunk {
+private:
+    std::vector<TileId> palette;    // The distinct tiles; never shrinks until compacted.
+    std::vector<uint64_t> indices;  // CHUNK_TILE_COUNT packed palette indices.
+    int bitsPerTile;
+
+    int getIndex(int tile) const;
+    void setIndex(int tile, int index);
+
+    /// @brief Repacks the indices with a new width.
+    void repack(int newBitsPerTile);
+
+public:
+    /// @brief Gets a tile.
+    /// @param x The column within the chunk, 0 to CHUNK_SIZE - 1.
+    /// @param y The row within the chunk, 0 to CHUNK_SIZE - 1.
+    TileId getTile(int x, int y) const;
+
+    /// @brief Sets a tile, widening the indices if the chunk did not hold that tile yet.
+    /// @param x The column within the chunk, 0 to CHUNK_SIZE - 1.
+    /// @param y The row within the chunk, 0 to CHUNK_SIZE - 1.
+    /// @param tile The new tile.
+    /// @return True if the tile changed.
+    bool setTile(int x, int y, TileId tile);
+
+    /// @brief Drops tiles no longer used from the palette and narrows the indices if possible.
+    void compact();
+
+    /// @brief Run-length encodes the tiles in row-major order.
+    /// @param runs Cleared, then receives the runs; a chunk of one tile is one run.
+    void encode(std::vector<TileRun>& runs) const;
+
+    /// @brief Replaces the tiles with encoded ones.
+    /// @param runs Runs from encode().
+    /// @return False if the runs do not add up to exactly CHUNK_TILE_COUNT tiles; the chunk is unchanged then.
+    bool decode(std::span<const TileRun> runs);
+
+    /// @brief Gets the number of distinct tiles the palette holds.
+    size_t getPaletteSize() const;
+
+    /// @brief Gets the heap memory the chunk uses, in bytes.
+    size_t getMemoryUsage() const;
+
+    /// @brief Constructs a chunk filled with one tile.
+    explicit Chunk(TileId fill = TILE_AIR);
+};
+
+/// @brief The server's tile world: chunks are generated from the seed when first used and
+/// kept in a cache, along with their encoding for sending. Chunks that were not changed are
+/// evicted once unused for a while, since they can be generated again; changed chunks stay.
+class TileWorld {
+private:
+    struct CachedChunk {
+        Chunk chunk;
+        std::vector<TileRun> encoded;   // Empty until first requested, and after a change.
+        uint64_t lastUsedTick;
+        bool modified;
+    };
+
+    std::unordered_map<uint64_t, CachedChunk> chunks;
+    uint64_t seed;
+
+    CachedChunk& load(ChunkCoord coord, uint64_t tick);
+
+public:
+    /// @brief Fills a chunk with generated terrain. The same seed always generates the same chunk.
+    static void generate(uint64_t seed, ChunkCoord coord, Chunk& chunk);
+
+    /// @brief Gets a chunk, generating it if it is not cached.
+    /// @param coord The chunk position.
+    /// @param tick The current tick, to keep the chunk from being evicted.
+    const Chunk& getChunk(ChunkCoord coord, uint64_t tick);
+
+    /// @brief Gets a chunk's run-length encoding, encoding it only if it changed since the last call.
+    /// @param coord The chunk position.
+    /// @param tick The current tick, to keep the chunk from being evicted.
+    std::span<const TileRun> getEncodedChunk(ChunkCoord coord, uint64_t tick);
+
+    /// @brief Gets a tile, generating its chunk if it is not cached.
+    TileId getTile(int32_t tileX, int32_t tileY, uint64_t tick);
+
+    /// @brief Sets a tile. The chunk is kept in the cache from then on.
+    /// @return True if the tile changed.
+    bool setTile(int32_t tileX, int32_t tileY, TileId tile, uint64_t tick);
+
+    /// @brief Evicts the unchanged chunks not used since the given tick.
+    /// @return The number of chunks evicted.
+    size_t evictUnusedSince(uint64_t tick);
+
+    /// @brief Gets the number of cached chunks.
+    size_t getCachedCount() const;
+
+    /// @brief Constructs an empty world.
+    /// @param seed The seed the terrain is generated from.
+    explicit TileWorld(uint64_t seed = 0);
+};
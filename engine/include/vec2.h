@@ -0,0 +1,41 @@
+#pragma once
+
+#include <type_traits>
+
+/// @brief A 2D vector of any scalar type: float for EVec, or a FixedPoint type where the
+/// simulation has to give bit-identical results on every compiler and machine.
+template <typename Scalar>
+struct Vec2 {
+    Scalar x;  // x coordinate of the vector
+    Scalar y;  // y coordinate of the vector
+};
+
+template <typename Scalar>
+constexpr Vec2<Scalar> operator+(const Vec2<Scalar>& a, const Vec2<Scalar>& b) {
+    return Vec2<Scalar>{a.x + b.x, a.y + b.y};
+}
+
+template <typename Scalar>
+constexpr Vec2<Scalar> operator-(const Vec2<Scalar>& a, const Vec2<Scalar>& b) {
+    return Vec2<Scalar>{a.x - b.x, a.y - b.y};
+}
+
+template <typename Scalar>
+constexpr Vec2<Scalar> operator*(const Vec2<Scalar>& v, std::type_identity_t<Scalar> s) {
+    return Vec2<Scalar>{v.x * s, v.y * s};
+}
+
+template <typename Scalar>
+constexpr bool operator==(const Vec2<Scalar>& a, const Vec2<Scalar>& b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+/// @brief Linearly interpolates between two vectors.
+/// @param start The vector at t = 0.
+/// @param end The vector at t = 1.
+/// @param t How far to go from start towards end.
+/// @return start + t * (end - start), evaluated per component in that order.
+template <typename Scalar>
+constexpr Vec2<Scalar> Lerp(const Vec2<Scalar>& start, const Vec2<Scalar>& end, std::type_identity_t<Scalar> t) {
+    return Vec2<Scalar>{start.x + t * (end.x - start.x), start.y + t * (end.y - start.y)};
+}
@@ -0,0 +1,88 @@
+#include <item_registry.h>
+#include <json_field.h>
+#include <mapped_file.h>
+
+bool ItemRegistry::registerItem(ItemId id, std::string_view name, uint16_t maxStackSize, std::string& err) {
+    if (id == ITEM_NONE) {
+        err = "item id 0 is reserved for empty slots";
+        return false;
+    }
+    if (name.empty() || maxStackSize == 0) {
+        err = "item " + std::to_string(id) + " needs a name and a max stack size of at least 1";
+        return false;
+    }
+    if (isValid(id)) {
+        err = "item id " + std::to_string(id) + " is used by both '" + definitions[id].name + "' and '" + std::string(name) + "'";
+        return false;
+    }
+    if (ids.find(name) != ids.end()) {
+        err = "item name '" + std::string(name) + "' is used twice";
+        return false;
+    }
+
+    if (id >= definitions.size()) {
+        definitions.resize(size_t(id) + 1, ItemDefinition{std::string(), 0});
+    }
+    definitions[id] = ItemDefinition{std::string(name), maxStackSize};
+    ids.emplace(std::string(name), id);
+    return true;
+}
+
+bool ItemRegistry::loadFromJson(const char* json, size_t length, std::string& err) {
+    picojson::value v;
+    picojson::parse(v, json, json + length, &err);
+    if (!err.empty()) {
+        return false;
+    }
+    if (!v.is<picojson::object>() || !getJsonField(v.get<picojson::object>(), "items").is<picojson::array>()) {
+        err = "item file has no 'items' array";
+        return false;
+    }
+
+    for (const picojson::value& item : getJsonField(v.get<picojson::object>(), "items").get<picojson::array>()) {
+        if (!item.is<picojson::object>()) {
+            err = "item is not an object";
+            return false;
+        }
+        const picojson::object& itemObj = item.get<picojson::object>();
+        const picojson::value& id = getJsonField(itemObj, "id");
+        const picojson::value& name = getJsonField(itemObj, "name");
+        const picojson::value& maxStackSize = getJsonField(itemObj, "maxStackSize");
+        if (!id.is<double>() || !name.is<std::string>() || !maxStackSize.is<double>() ||
+            id.get<double>() < 0 || id.get<double>() > 0xFFFF || maxStackSize.get<double>() < 1 || maxStackSize.get<double>() > 0xFFFF) {
+            err = "item needs a numeric 'id' (1-65535), a 'name' and a 'maxStackSize' (1-65535)";
+            return false;
+        }
+        if (!registerItem(ItemId(id.get<double>()), name.get<std::string>(), uint16_t(maxStackSize.get<double>()), err)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ItemRegistry::loadFromFile(const std::string& path, std::string& err) {
+    MappedFile file;
+    if (!file.open(path)) {
+        err = "could not read " + path;
+        return false;
+    }
+    return loadFromJson(reinterpret_cast<const char*>(file.data()), file.size(), err);
+}
+
+void ItemRegistry::clear() {
+    definitions.clear();
+    ids.clear();
+}
+
+std::string_view ItemRegistry::getName(ItemId id) const {
+    return id < definitions.size() ? std::string_view(definitions[id].name) : std::string_view();
+}
+
+ItemId ItemRegistry::findId(std::string_view name) const {
+    auto it = ids.find(name);
+    return it != ids.end() ? it->second : ItemId(ITEM_NONE);
+}
+
+size_t ItemRegistry::getCount() const {
+    return ids.size();
+}
@@ -0,0 +1,219 @@
+#include <logger.h>
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+#define LOG_IDLE_SLEEP_MS 2
+
+static_assert((LOG_RING_CAPACITY & (LOG_RING_CAPACITY - 1)) == 0, "LOG_RING_CAPACITY must be a power of two");
+
+static const char* getLevelName(LogLevel level) {
+    switch (level) {
+        case DEBUG: return "DEBUG";
+        case INFO: return "INFO";
+        case WARNING: return "WARNING";
+        case ERROR: return "ERROR";
+        case CRITICAL: return "CRITICAL";
+    }
+    return "LOG";
+}
+
+static int64_t getTimestamp() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+GameLogger::GameLogger()
+    : cells(new Cell[LOG_RING_CAPACITY]), enqueuePos(0), dequeuePos(0), droppedRecords(0),
+      minimumLevel(LOG_COMPILE_MIN_LEVEL), logLevel(INFO), stopping(false) {
+    for (uint64_t i = 0; i < LOG_RING_CAPACITY; ++i) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    flusher = std::thread(&GameLogger::flusherLoop, this);
+}
+
+GameLogger::~GameLogger() {
+    stopping.store(true, std::memory_order_release);
+    flusher.join();
+}
+
+LogLevel GameLogger::getLogLevel() {
+    return logLevel.load(std::memory_order_relaxed);
+}
+
+void GameLogger::setLogLevel(LogLevel level) {
+    logLevel.store(level, std::memory_order_relaxed);
+}
+
+LogLevel GameLogger::getMinimumLevel() const {
+    return LogLevel(minimumLevel.load(std::memory_order_relaxed));
+}
+
+void GameLogger::setMinimumLevel(LogLevel level) {
+    minimumLevel.store(int(level), std::memory_order_relaxed);
+}
+
+uint64_t GameLogger::getDroppedCount() const {
+    return droppedRecords.load(std::memory_order_relaxed);
+}
+
+GameLogger::Cell* GameLogger::claim(uint64_t& pos) {
+    // Bounded multi-producer queue: a slot is free for position pos when its
+    // sequence equals pos, and readable by the flusher when it equals pos + 1.
+    pos = enqueuePos.load(std::memory_order_relaxed);
+    while (true) {
+        Cell* cell = &cells[pos & (LOG_RING_CAPACITY - 1)];
+        uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+        int64_t diff = int64_t(sequence) - int64_t(pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                return cell;
+            }
+        } else if (diff < 0) {
+            droppedRecords.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;  // Full, never block the caller.
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void GameLogger::publish(Cell* cell, uint64_t pos) {
+    cell->sequence.store(pos + 1, std::memory_order_release);
+}
+
+void GameLogger::Log(std::string_view msg) {
+    Log(getLogLevel(), msg);
+}
+
+void GameLogger::Log(LogLevel level, std::string_view msg) {
+    if (!isEnabled(level)) {
+        return;
+    }
+
+    uint64_t pos;
+    Cell* cell = claim(pos);
+    if (cell == nullptr) {
+        return;
+    }
+
+    size_t length = msg.size() < LOG_MESSAGE_CAPACITY - 1 ? msg.size() : LOG_MESSAGE_CAPACITY - 1;
+    std::memcpy(cell->record.message, msg.data(), length);
+    cell->record.message[length] = '\0';
+    cell->record.length = uint16_t(length);
+    cell->record.level = level;
+    cell->record.timestamp = getTimestamp();
+    publish(cell, pos);
+
+    if (level >= CRITICAL) {
+        flush();
+    }
+}
+
+void GameLogger::Logf(LogLevel level, const char* format, ...) {
+    if (!isEnabled(level)) {
+        return;
+    }
+
+    uint64_t pos;
+    Cell* cell = claim(pos);
+    if (cell == nullptr) {
+        return;
+    }
+
+    // Format straight into the slot, no intermediate strings.
+    va_list args;
+    va_start(args, format);
+    int length = std::vsnprintf(cell->record.message, LOG_MESSAGE_CAPACITY, format, args);
+    va_end(args);
+    if (length < 0) {
+        length = 0;
+        cell->record.message[0] = '\0';
+    } else if (length >= LOG_MESSAGE_CAPACITY) {
+        length = LOG_MESSAGE_CAPACITY - 1;
+    }
+    cell->record.length = uint16_t(length);
+    cell->record.level = level;
+    cell->record.timestamp = getTimestamp();
+    publish(cell, pos);
+
+    if (level >= CRITICAL) {
+        flush();
+    }
+}
+
+size_t GameLogger::drain() {
+    std::string output;
+    size_t count = 0;
+    uint64_t pos = dequeuePos.load(std::memory_order_relaxed);
+
+    while (true) {
+        Cell* cell = &cells[pos & (LOG_RING_CAPACITY - 1)];
+        if (cell->sequence.load(std::memory_order_acquire) != pos + 1) {
+            break;
+        }
+
+        const Record& record = cell->record;
+        std::time_t seconds = std::time_t(record.timestamp / 1000000000);
+        int milliseconds = int((record.timestamp / 1000000) % 1000);
+        std::tm localTime;
+#ifdef _WIN32
+        localtime_s(&localTime, &seconds);
+#else
+        localtime_r(&seconds, &localTime);
+#endif
+        char prefix[48];
+        int prefixLength = std::snprintf(prefix, sizeof(prefix), "[%02d:%02d:%02d.%03d] %s: ",
+                                         localTime.tm_hour, localTime.tm_min, localTime.tm_sec,
+                                         milliseconds, getLevelName(record.level));
+        output.append(prefix, size_t(prefixLength));
+        output.append(record.message, record.length);
+        output.push_back('\n');
+
+        // Hand the slot back to producers for the next lap around the ring.
+        cell->sequence.store(pos + LOG_RING_CAPACITY, std::memory_order_release);
+        ++pos;
+        ++count;
+    }
+
+    if (count > 0) {
+        std::fwrite(output.data(), 1, output.size(), stderr);
+        std::fflush(stderr);
+        dequeuePos.store(pos, std::memory_order_release);
+    }
+    return count;
+}
+
+void GameLogger::flusherLoop() {
+    uint64_t reportedDrops = 0;
+    while (true) {
+        bool stop = stopping.load(std::memory_order_acquire);
+        size_t drained = drain();
+
+        uint64_t dropped = droppedRecords.load(std::memory_order_relaxed);
+        if (dropped != reportedDrops) {
+            std::fprintf(stderr, "WARNING: %llu log records dropped, logger ring buffer was full\n",
+                         (unsigned long long)(dropped - reportedDrops));
+            reportedDrops = dropped;
+        }
+
+        if (stop) {
+            return;
+        }
+        if (drained == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(LOG_IDLE_SLEEP_MS));
+        }
+    }
+}
+
+void GameLogger::flush() {
+    uint64_t target = enqueuePos.load(std::memory_order_acquire);
+    while (dequeuePos.load(std::memory_order_acquire) < target && flusher.joinable() &&
+           std::this_thread::get_id() != flusher.get_id()) {
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,148 @@
+#include <metrics.h>
+
+#include <cstdio>
+#include <filesystem>
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds(std::move(bounds)), buckets(std::make_unique<std::atomic<uint64_t>[]>(this->bounds.size() + 1)) {
+}
+
+void Histogram::observe(double sample) {
+    size_t index = 0;
+    while (index < bounds.size() && sample > bounds[index]) {
+        index++;
+    }
+    buckets[index].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(sample, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+}
+
+MetricsRegistry::Family& MetricsRegistry::getFamily(const std::string& name, MetricType type, const std::string& help) {
+    auto it = families.find(name);
+    if (it == families.end()) {
+        it = families.emplace(name, Family{}).first;
+        it->second.type = type;
+        it->second.help = help;
+    }
+    return it->second;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& metric = getFamily(name, METRIC_COUNTER, help).counters[labels];
+    if (!metric) {
+        metric = std::make_unique<Counter>();
+    }
+    return *metric;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& metric = getFamily(name, METRIC_GAUGE, help).gauges[labels];
+    if (!metric) {
+        metric = std::make_unique<Gauge>();
+    }
+    return *metric;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, const std::vector<double>& bounds,
+                                      const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Family& family = getFamily(name, METRIC_HISTOGRAM, help);
+    if (family.bounds.empty()) {
+        family.bounds = bounds;
+    }
+    auto& metric = family.histograms[labels];
+    if (!metric) {
+        metric = std::make_unique<Histogram>(family.bounds);
+    }
+    return *metric;
+}
+
+void MetricsRegistry::removeLabels(const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [name, family] : families) {
+        family.counters.erase(labels);
+        family.gauges.erase(labels);
+        family.histograms.erase(labels);
+    }
+}
+
+static void appendSample(std::string& out, const std::string& name, const std::string& labels, double value) {
+    char number[64];
+    std::snprintf(number, sizeof(number), "%.17g", value);
+    out += name;
+    if (!labels.empty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += number;
+    out += '\n';
+}
+
+static std::string joinLabels(const std::string& labels, const std::string& extra) {
+    return labels.empty() ? extra : labels + "," + extra;
+}
+
+std::string MetricsRegistry::renderPrometheus() const {
+    static const char* typeNames[] = {"counter", "gauge", "histogram"};
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string out;
+    out.reserve(families.size() * 128);
+
+    for (const auto& [name, family] : families) {
+        if (family.counters.empty() && family.gauges.empty() && family.histograms.empty()) {
+            continue;
+        }
+        out += "# HELP " + name + " " + family.help + "\n";
+        out += "# TYPE " + name + " " + typeNames[family.type] + "\n";
+
+        for (const auto& [labels, counter] : family.counters) {
+            appendSample(out, name, labels, double(counter->get()));
+        }
+        for (const auto& [labels, gauge] : family.gauges) {
+            appendSample(out, name, labels, gauge->get());
+        }
+        for (const auto& [labels, histogram] : family.histograms) {
+            // Buckets are stored individually but exposed cumulatively.
+            uint64_t cumulative = 0;
+            const std::vector<double>& bounds = histogram->getBounds();
+            for (size_t i = 0; i <= bounds.size(); ++i) {
+                cumulative += histogram->getBucketCount(i);
+                char bound[64];
+                if (i < bounds.size()) {
+                    std::snprintf(bound, sizeof(bound), "le=\"%g\"", bounds[i]);
+                } else {
+                    std::snprintf(bound, sizeof(bound), "le=\"+Inf\"");
+                }
+                appendSample(out, name + "_bucket", joinLabels(labels, bound), double(cumulative));
+            }
+            appendSample(out, name + "_sum", labels, histogram->getSum());
+            appendSample(out, name + "_count", labels, double(histogram->getCount()));
+        }
+    }
+    return out;
+}
+
+bool MetricsRegistry::writeToFile(const std::string& path) const {
+    // Write next to the target and rename, so readers never see a partial file.
+    std::string text = renderPrometheus();
+    std::string temporaryPath = path + ".tmp";
+
+    FILE* file = std::fopen(temporaryPath.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temporaryPath, path, ec);
+    return !ec;
+}
@@ -0,0 +1,59 @@
+#include <profiler.h>
+
+#include <cstdio>
+
+static_assert((PROFILER_THREAD_CAPACITY & (PROFILER_THREAD_CAPACITY - 1)) == 0, "PROFILER_THREAD_CAPACITY must be a power of two");
+
+Profiler::Profiler() : epoch(std::chrono::steady_clock::now()), enabled(true) {
+}
+
+Profiler::ThreadBuffer* Profiler::registerThread() {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->threadId = uint32_t(buffers.size()) + 1;
+    buffer->zones = std::make_unique<Zone[]>(PROFILER_THREAD_CAPACITY);
+    buffer->head.store(0, std::memory_order_relaxed);
+    buffers.push_back(std::move(buffer));
+    return buffers.back().get();
+}
+
+void Profiler::record(const char* name, uint64_t start, uint64_t end) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    thread_local ThreadBuffer* buffer = registerThread();
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    buffer->zones[head & (PROFILER_THREAD_CAPACITY - 1)] = Zone{name, start, end - start};
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::setEnabled(bool enable) {
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+bool Profiler::writeChromeTrace(const char* path) {
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    std::fputs("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n", file);
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (const auto& buffer : buffers) {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = head > PROFILER_THREAD_CAPACITY ? head - PROFILER_THREAD_CAPACITY : 0;
+        for (uint64_t i = begin; i < head; ++i) {
+            const Zone& zone = buffer->zones[i & (PROFILER_THREAD_CAPACITY - 1)];
+            // Complete ("X") events take microseconds; zone names are identifiers, so they need no escaping.
+            std::fprintf(file, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                         first ? "" : ",\n", zone.name, buffer->threadId, zone.start / 1000.0, zone.duration / 1000.0);
+            first = false;
+        }
+    }
+
+    std::fputs("\n]}\n", file);
+    return std::fclose(file) == 0;
+}
@@ -0,0 +1,24 @@
+#include <rate_limiter.h>
+
+void TokenBucket::refill(uint32_t nowMs, float ratePerSecond, float burst) {
+    // Unsigned subtraction keeps working when the clock wraps.
+    uint32_t elapsedMs = nowMs - lastRefillMs;
+    lastRefillMs = nowMs;
+    tokens += float(elapsedMs) * ratePerSecond * 0.001f;
+    if (tokens > burst) {
+        tokens = burst;
+    }
+}
+
+bool TokenBucket::take(uint32_t nowMs, float ratePerSecond, float burst, float cost) {
+    refill(nowMs, ratePerSecond, burst);
+    if (tokens < cost) {
+        return false;
+    }
+    tokens -= cost;
+    return true;
+}
+
+bool TokenBucket::isFull(uint32_t nowMs, float ratePerSecond, float burst) const {
+    return tokens + float(nowMs - lastRefillMs) * ratePerSecond * 0.001f >= burst;
+}
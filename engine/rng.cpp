@@ -0,0 +1,101 @@
+#include <rng.h>
+
+#include <bit>
+#include <optional>
+#include <random>
+
+Random::Random(uint64_t seed) : state() {
+    // splitmix64, as recommended by xoshiro's authors: never gives the all-zero state.
+    for (uint64_t& word : state) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        word = z ^ (z >> 31);
+    }
+}
+
+uint64_t Random::next() {
+    uint64_t result = std::rotl(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = std::rotl(state[3], 45);
+    return result;
+}
+
+uint32_t Random::nextBelow(uint32_t bound) {
+    // Lemire's multiply-shift; the retry removes the bias and almost never runs.
+    uint64_t product = (next() >> 32) * bound;
+    if (uint32_t(product) < bound) {
+        uint32_t threshold = uint32_t(-bound) % bound;
+        while (uint32_t(product) < threshold) {
+            product = (next() >> 32) * bound;
+        }
+    }
+    return uint32_t(product >> 32);
+}
+
+int Random::nextInt(int min, int max) {
+    uint32_t span = uint32_t(max) - uint32_t(min) + 1;
+    // span wraps to 0 for the full int range, where every 32-bit value is fine.
+    return int(uint32_t(min) + (span == 0 ? uint32_t(next() >> 32) : nextBelow(span)));
+}
+
+float Random::nextFloat() {
+    // The top 24 bits fill the float's mantissa exactly.
+    return float(next() >> 40) * 0x1.0p-24f;
+}
+
+double Random::nextDouble() {
+    return double(next() >> 11) * 0x1.0p-53;
+}
+
+void Random::fill(std::span<uint64_t> out) {
+    for (uint64_t& value : out) {
+        value = next();
+    }
+}
+
+void Random::fillFloats(std::span<float> out, float min, float max) {
+    float scale = max - min;
+    for (float& value : out) {
+        value = min + nextFloat() * scale;
+    }
+}
+
+void Random::jump() {
+    static constexpr uint64_t JUMP[] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+    uint64_t jumped[4] = {0, 0, 0, 0};
+    for (uint64_t word : JUMP) {
+        for (int bit = 0; bit < 64; ++bit) {
+            if (word & (uint64_t(1) << bit)) {
+                for (int i = 0; i < 4; ++i) {
+                    jumped[i] ^= state[i];
+                }
+            }
+            next();
+        }
+    }
+    for (int i = 0; i < 4; ++i) {
+        state[i] = jumped[i];
+    }
+}
+
+/// @brief The calling thread's generator, created on first use.
+static thread_local std::optional<Random> threadRandom;
+
+Random& Random::getThreadLocal() {
+    if (!threadRandom) {
+        // One random_device read per thread, instead of one per random number.
+        std::random_device device;
+        threadRandom.emplace(uint64_t(device()) << 32 | device());
+    }
+    return *threadRandom;
+}
+
+void Random::seedThreadLocal(uint64_t seed) {
+    threadRandom.emplace(seed);
+}
@@ -0,0 +1,139 @@
+#include <scene_format.h>
+#include <logger.h>
+#include <profiler.h>
+#include <json_field.h>
+
+#include <cstring>
+
+static bool sectionFits(uint64_t offset, uint64_t length, size_t size) {
+    return offset % 4 == 0 && offset + length <= size;
+}
+
+const SceneBinaryHeader* validateSceneBinary(const unsigned char* data, size_t size) {
+    if (data == nullptr || size < sizeof(SceneBinaryHeader)) {
+        return nullptr;
+    }
+
+    const SceneBinaryHeader* header = reinterpret_cast<const SceneBinaryHeader*>(data);
+    if (header->magic != SCENE_BINARY_MAGIC ||
+        header->version != SCENE_BINARY_VERSION ||
+        header->headerSize != sizeof(SceneBinaryHeader) ||
+        header->fileSize != size) {
+        return nullptr;
+    }
+
+    if (!sectionFits(header->stringTableOffset, header->stringTableSize, size) ||
+        !sectionFits(header->textEntityOffset, uint64_t(header->textEntityCount) * sizeof(SceneBinaryTextEntity), size)) {
+        return nullptr;
+    }
+
+    // Every string must be inside the string table and null-terminated, so
+    // loaders can hand the pointers straight to C APIs.
+    const char* strings = getSceneBinaryStrings(data, header);
+    const SceneBinaryTextEntity* textEntities = getSceneBinaryTextEntities(data, header);
+    for (uint32_t i = 0; i < header->textEntityCount; ++i) {
+        const SceneBinaryTextEntity& entity = textEntities[i];
+        if (uint64_t(entity.textOffset) + entity.textLength >= header->stringTableSize ||
+            strings[entity.textOffset + entity.textLength] != '\0') {
+            return nullptr;
+        }
+    }
+
+    return header;
+}
+
+static size_t alignTo4(size_t value) {
+    return (value + 3) & ~size_t(3);
+}
+
+static unsigned char getColorComponent(const picojson::object& colorObj, const char* key) {
+    const picojson::value& component = getJsonField(colorObj, key);
+    return component.is<double>() ? static_cast<unsigned char>(component.get<double>()) : 0;
+}
+
+bool compileScene(const char* json, size_t length, std::vector<unsigned char>& out, std::string& err) {
+    PROFILE_FUNCTION();
+    picojson::value v;
+    picojson::parse(v, json, json + length, &err);
+    if (!err.empty()) {
+        return false;
+    }
+    if (!v.is<picojson::object>() || !getJsonField(v.get<picojson::object>(), "entities").is<picojson::array>()) {
+        err = "scene has no 'entities' array";
+        return false;
+    }
+
+    std::string strings;
+    std::vector<SceneBinaryTextEntity> textEntities;
+
+    const picojson::array& entities = getJsonField(v.get<picojson::object>(), "entities").get<picojson::array>();
+    for (const picojson::value& entity : entities) {
+        if (!entity.is<picojson::object>()) {
+            GAME_LOG_WARNING("Skipping entity that is not an object");
+            continue;
+        }
+        const picojson::object& entityObj = entity.get<picojson::object>();
+        const picojson::value& type = getJsonField(entityObj, "type");
+        if (!type.is<std::string>()) {
+            GAME_LOG_WARNING("Skipping entity without a type");
+            continue;
+        }
+
+        if (type.get<std::string>() == "TextEntity") {
+            const picojson::value& text = getJsonField(entityObj, "text");
+            const picojson::value& position = getJsonField(entityObj, "position");
+            const picojson::value& color = getJsonField(entityObj, "color");
+            if (!text.is<std::string>() || !position.is<picojson::object>() || !color.is<picojson::object>()) {
+                GAME_LOG_WARNING("Skipping malformed TextEntity");
+                continue;
+            }
+
+            const picojson::object& positionObj = position.get<picojson::object>();
+            const picojson::object& colorObj = color.get<picojson::object>();
+            const std::string& textValue = text.get<std::string>();
+
+            SceneBinaryTextEntity record{};
+            record.x = getJsonField(positionObj, "x").is<double>() ? float(getJsonField(positionObj, "x").get<double>()) : 0.0f;
+            record.y = getJsonField(positionObj, "y").is<double>() ? float(getJsonField(positionObj, "y").get<double>()) : 0.0f;
+            record.textOffset = uint32_t(strings.size());
+            record.textLength = uint32_t(textValue.size());
+            record.r = getColorComponent(colorObj, "r");
+            record.g = getColorComponent(colorObj, "g");
+            record.b = getColorComponent(colorObj, "b");
+            record.a = getColorComponent(colorObj, "a");
+
+            strings.append(textValue);
+            strings.push_back('\0');
+            textEntities.push_back(record);
+        } else {
+            GAME_LOG_WARNING("Could not locate type: '%s'", type.get<std::string>().c_str());
+        }
+        // Add more entity types as needed
+    }
+
+    // Layout: header | text entities | string table, every section 4-byte aligned.
+    SceneBinaryHeader header{};
+    header.magic = SCENE_BINARY_MAGIC;
+    header.version = SCENE_BINARY_VERSION;
+    header.headerSize = sizeof(SceneBinaryHeader);
+    header.textEntityOffset = uint32_t(alignTo4(sizeof(SceneBinaryHeader)));
+    header.textEntityCount = uint32_t(textEntities.size());
+    header.stringTableOffset = uint32_t(alignTo4(header.textEntityOffset + textEntities.size() * sizeof(SceneBinaryTextEntity)));
+    header.stringTableSize = uint32_t(strings.size());
+    header.fileSize = uint32_t(alignTo4(header.stringTableOffset + strings.size()));
+
+    out.assign(header.fileSize, 0);
+    std::memcpy(out.data(), &header, sizeof(header));
+    if (!textEntities.empty()) {
+        std::memcpy(out.data() + header.textEntityOffset, textEntities.data(), textEntities.size() * sizeof(SceneBinaryTextEntity));
+    }
+    if (!strings.empty()) {
+        std::memcpy(out.data() + header.stringTableOffset, strings.data(), strings.size());
+    }
+
+    if (validateSceneBinary(out.data(), out.size()) == nullptr) {
+        err = "produced an invalid compiled scene";
+        return false;
+    }
+    return true;
+}
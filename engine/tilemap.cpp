@@ -0,0 +1,232 @@
+#include <tilemap.h>
+#include <profiler.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+ChunkCoord chunkCoordAt(EVec position) {
+    return chunkCoordOfTile(int32_t(std::floor(position.x / TILE_SIZE)), int32_t(std::floor(position.y / TILE_SIZE)));
+}
+
+ChunkCoord chunkCoordOfTile(int32_t tileX, int32_t tileY) {
+    // Arithmetic shifts round towards negative infinity, unlike division.
+    static_assert(std::has_single_bit(unsigned(CHUNK_SIZE)));
+    constexpr int shift = std::countr_zero(unsigned(CHUNK_SIZE));
+    return ChunkCoord{tileX >> shift, tileY >> shift};
+}
+
+uint64_t chunkKey(ChunkCoord coord) {
+    return uint64_t(uint32_t(coord.x)) << 32 | uint64_t(uint32_t(coord.y));
+}
+
+Chunk::Chunk(TileId fill) : palette{fill}, indices(), bitsPerTile(0) {
+}
+
+int Chunk::getIndex(int tile) const {
+    if (bitsPerTile == 0) {
+        return 0;
+    }
+    // Widths are powers of two, so an index never straddles two words.
+    size_t bit = size_t(tile) * size_t(bitsPerTile);
+    return int((indices[bit / 64] >> (bit % 64)) & ((uint64_t(1) << bitsPerTile) - 1));
+}
+
+void Chunk::setIndex(int tile, int index) {
+    size_t bit = size_t(tile) * size_t(bitsPerTile);
+    uint64_t mask = ((uint64_t(1) << bitsPerTile) - 1) << (bit % 64);
+    indices[bit / 64] = (indices[bit / 64] & ~mask) | (uint64_t(index) << (bit % 64));
+}
+
+void Chunk::repack(int newBitsPerTile) {
+    std::vector<uint64_t> old = std::move(indices);
+    int oldBitsPerTile = bitsPerTile;
+
+    bitsPerTile = newBitsPerTile;
+    indices.assign(newBitsPerTile == 0 ? 0 : CHUNK_TILE_COUNT * size_t(newBitsPerTile) / 64, 0);
+    if (newBitsPerTile == 0) {
+        return;
+    }
+    for (int tile = 0; tile < CHUNK_TILE_COUNT; ++tile) {
+        int index = 0;
+        if (oldBitsPerTile != 0) {
+            size_t bit = size_t(tile) * size_t(oldBitsPerTile);
+            index = int((old[bit / 64] >> (bit % 64)) & ((uint64_t(1) << oldBitsPerTile) - 1));
+        }
+        setIndex(tile, index);
+    }
+}
+
+TileId Chunk::getTile(int x, int y) const {
+    return palette[size_t(getIndex(y * CHUNK_SIZE + x))];
+}
+
+bool Chunk::setTile(int x, int y, TileId tile) {
+    int position = y * CHUNK_SIZE + x;
+    if (palette[size_t(getIndex(position))] == tile) {
+        return false;
+    }
+
+    auto it = std::find(palette.begin(), palette.end(), tile);
+    int index = int(it - palette.begin());
+    if (it == palette.end()) {
+        palette.push_back(tile);
+        // Smallest power-of-two width that can address the whole palette.
+        int needed = int(std::bit_ceil(unsigned(std::bit_width(palette.size() - 1))));
+        if (needed > bitsPerTile) {
+            repack(needed);
+        }
+    }
+    setIndex(position, index);
+    return true;
+}
+
+void Chunk::compact() {
+    std::vector<TileId> tiles(CHUNK_TILE_COUNT);
+    for (int tile = 0; tile < CHUNK_TILE_COUNT; ++tile) {
+        tiles[size_t(tile)] = palette[size_t(getIndex(tile))];
+    }
+
+    std::vector<TileId> used;
+    for (TileId tile : tiles) {
+        if (std::find(used.begin(), used.end(), tile) == used.end()) {
+            used.push_back(tile);
+        }
+    }
+    if (used.size() == palette.size()) {
+        return;
+    }
+
+    palette = std::move(used);
+    repack(palette.size() == 1 ? 0 : int(std::bit_ceil(unsigned(std::bit_width(palette.size() - 1)))));
+    if (bitsPerTile == 0) {
+        return;
+    }
+    for (int tile = 0; tile < CHUNK_TILE_COUNT; ++tile) {
+        setIndex(tile, int(std::find(palette.begin(), palette.end(), tiles[size_t(tile)]) - palette.begin()));
+    }
+}
+
+void Chunk::encode(std::vector<TileRun>& runs) const {
+    runs.clear();
+    if (bitsPerTile == 0) {
+        runs.push_back(TileRun{CHUNK_TILE_COUNT, palette[0]});
+        return;
+    }
+
+    int runIndex = getIndex(0);
+    uint16_t runLength = 0;
+    for (int tile = 0; tile < CHUNK_TILE_COUNT; ++tile) {
+        int index = getIndex(tile);
+        if (index != runIndex) {
+            runs.push_back(TileRun{runLength, palette[size_t(runIndex)]});
+            runIndex = index;
+            runLength = 0;
+        }
+        ++runLength;
+    }
+    runs.push_back(TileRun{runLength, palette[size_t(runIndex)]});
+}
+
+bool Chunk::decode(std::span<const TileRun> runs) {
+    size_t total = 0;
+    for (const TileRun& run : runs) {
+        total += run.length;
+    }
+    if (total != CHUNK_TILE_COUNT) {
+        return false;
+    }
+
+    *this = Chunk(runs[0].tile);
+    int position = 0;
+    for (const TileRun& run : runs) {
+        for (int i = 0; i < run.length; ++i, ++position) {
+            setTile(position % CHUNK_SIZE, position / CHUNK_SIZE, run.tile);
+        }
+    }
+    return true;
+}
+
+size_t Chunk::getPaletteSize() const {
+    return palette.size();
+}
+
+size_t Chunk::getMemoryUsage() const {
+    return palette.capacity() * sizeof(TileId) + indices.capacity() * sizeof(uint64_t);
+}
+
+TileWorld::TileWorld(uint64_t seed) : chunks(), seed(seed) {
+}
+
+/// @brief Hashes a seed and a position into 64 well mixed bits (splitmix64 finalizer).
+static uint64_t hashPosition(uint64_t seed, int32_t x, int32_t y) {
+    uint64_t z = seed ^ (uint64_t(uint32_t(x)) << 32 | uint64_t(uint32_t(y)));
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void TileWorld::generate(uint64_t seed, ChunkCoord coord, Chunk& chunk) {
+    // Terrain comes in 8x8 tile patches, so chunks compress to a few dozen runs.
+    constexpr int patch = 8;
+    chunk = Chunk(TILE_GRASS);
+    for (int py = 0; py < CHUNK_SIZE / patch; ++py) {
+        for (int px = 0; px < CHUNK_SIZE / patch; ++px) {
+            uint64_t h = hashPosition(seed, coord.x * (CHUNK_SIZE / patch) + px, coord.y * (CHUNK_SIZE / patch) + py);
+            TileId tile = h % 16 == 0 ? TileId(TILE_WATER) : h % 8 == 1 ? TileId(TILE_STONE) : TileId(TILE_GRASS);
+            if (tile == TILE_GRASS) {
+                continue;
+            }
+            for (int y = 0; y < patch; ++y) {
+                for (int x = 0; x < patch; ++x) {
+                    chunk.setTile(px * patch + x, py * patch + y, tile);
+                }
+            }
+        }
+    }
+}
+
+TileWorld::CachedChunk& TileWorld::load(ChunkCoord coord, uint64_t tick) {
+    auto [it, inserted] = chunks.try_emplace(chunkKey(coord), CachedChunk{Chunk(), {}, tick, false});
+    if (inserted) {
+        PROFILE_ZONE("GenerateChunk");
+        generate(seed, coord, it->second.chunk);
+    }
+    it->second.lastUsedTick = tick;
+    return it->second;
+}
+
+const Chunk& TileWorld::getChunk(ChunkCoord coord, uint64_t tick) {
+    return load(coord, tick).chunk;
+}
+
+std::span<const TileRun> TileWorld::getEncodedChunk(ChunkCoord coord, uint64_t tick) {
+    CachedChunk& cached = load(coord, tick);
+    if (cached.encoded.empty()) {
+        cached.chunk.encode(cached.encoded);
+    }
+    return cached.encoded;
+}
+
+TileId TileWorld::getTile(int32_t tileX, int32_t tileY, uint64_t tick) {
+    return getChunk(chunkCoordOfTile(tileX, tileY), tick).getTile(tileX & (CHUNK_SIZE - 1), tileY & (CHUNK_SIZE - 1));
+}
+
+bool TileWorld::setTile(int32_t tileX, int32_t tileY, TileId tile, uint64_t tick) {
+    CachedChunk& cached = load(chunkCoordOfTile(tileX, tileY), tick);
+    if (!cached.chunk.setTile(tileX & (CHUNK_SIZE - 1), tileY & (CHUNK_SIZE - 1), tile)) {
+        return false;
+    }
+    cached.encoded.clear();
+    cached.modified = true;
+    return true;
+}
+
+size_t TileWorld::evictUnusedSince(uint64_t tick) {
+    return std::erase_if(chunks, [tick](const auto& entry) { return !entry.second.modified && entry.second.lastUsedTick < tick; });
+}
+
+size_t TileWorld::getCachedCount() const {
+    return chunks.size();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <enet.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Computes the CRC32C (Castagnoli) checksum of a byte range.
+/// Uses the SSE4.2 crc32 instruction when the CPU has it and a table-driven
+/// fallback otherwise; the choice is made once, at startup.
+/// @param data The bytes to checksum.
+/// @param length The number of bytes.
+/// @param crc The checksum of the bytes before data, to continue a running checksum; 0 to start.
+/// @return The checksum of everything so far.
+uint32_t net_crc32c(const void* data, size_t length, uint32_t crc = 0);
+
+/// @brief Computes the CRC32C of a scattered datagram, in place, as one continuous byte range.
+/// Matches ENetChecksumCallback, so it can be set as host->checksum.
+/// @param buffers The pieces of the datagram.
+/// @param bufferCount The number of pieces.
+/// @return The checksum of all pieces in order.
+enet_uint32 net_crc32c_buffers(const ENetBuffer* buffers, size_t bufferCount);
+
+/// @brief Makes a host checksum every datagram it sends and drop received datagrams that fail the check.
+/// Both ends of a connection must enable it, since it adds four bytes to every datagram header.
+/// Set it right after creating the host, before any connection is made.
+/// @param host The host to protect.
+void net_enable_checksum(ENetHost* host);
+
+/// @brief Gets the name of the CRC32C implementation in use, for logs and benchmarks.
+/// @return "sse4.2" or "table".
+const char* net_crc32c_implementation();
@@ -1,2 +1,25 @@
+#pragma once
+
+#include <enet.h>
+
 #define DEFAULT_SERVER_PORT 6777
-#define DEFAULT_SERVER_ADDRESS "127.0.0.1"
\ No newline at end of file
+#define DEFAULT_SERVER_ADDRESS "127.0.0.1"
+
+/// @brief Checks whether a raw datagram is a connection attempt, without any per-peer state.
+/// Connection attempts are addressed to no peer and start with a CONNECT command.
+/// Use it from an intercept callback (on host->receivedData) to refuse connects cheaply.
+/// @param host The receiving host; needed to know whether datagrams carry a checksum.
+/// @param data The datagram.
+/// @param dataLength The datagram length.
+/// @return True if the datagram would make the host allocate a peer.
+bool net_is_connect_datagram(const ENetHost* host, const enet_uint8* data, size_t dataLength);
+
+/// @brief Feeds a raw datagram to a host as if it had just been read from its socket.
+/// Events it produces are queued and returned by the next enet_host_service call.
+/// The host's intercept callback is not invoked.
+/// @param host The host receiving the datagram.
+/// @param address The address the datagram came from.
+/// @param data The datagram contents.
+/// @param dataLength The datagram length; must not exceed ENET_PROTOCOL_MAXIMUM_MTU.
+/// @return 0 on success, -1 if the datagram was too large or caused a protocol error.
+int net_inject_datagram(ENetHost* host, const ENetAddress* address, const void* data, size_t dataLength);
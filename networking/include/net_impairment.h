@@ -0,0 +1,105 @@
+#pragma once
+
+#include <enet.h>
+
+#include <cstdint>
+#include <vector>
+
+/// @brief Describes the network conditions simulated on a host's incoming datagrams.
+typedef struct {
+    enet_uint32 latencyMs;              // Fixed delay added to every datagram.
+    enet_uint32 jitterMs;               // Random delay in [-jitterMs, +jitterMs] added on top of the latency.
+    float lossRate;                     // Probability [0, 1] that a datagram is dropped.
+    float duplicateRate;                // Probability [0, 1] that a datagram is delivered twice.
+    float reorderRate;                  // Probability [0, 1] that a datagram is held back behind later ones.
+    enet_uint32 reorderDelayMs;         // Extra delay applied to reordered datagrams.
+    enet_uint32 bandwidthBytesPerSec;   // Link capacity, 0 for unlimited.
+    enet_uint32 queueLimitMs;           // Datagrams that would wait longer than this for the link are dropped.
+    uint64_t seed;                      // Seed for every random decision.
+} NetImpairmentConfig;
+
+/// @brief Counters describing what the impairment layer did to the traffic.
+typedef struct {
+    uint64_t received;       // Datagrams read from the socket.
+    uint64_t delivered;      // Datagrams handed to ENet, including duplicates.
+    uint64_t lost;           // Datagrams dropped by lossRate.
+    uint64_t overflowed;     // Datagrams dropped because the bandwidth queue was full.
+    uint64_t duplicated;     // Extra copies created by duplicateRate.
+    uint64_t reordered;      // Datagrams held back by reorderRate.
+} NetImpairmentStats;
+
+/// @brief Returns a configuration that leaves the traffic untouched.
+NetImpairmentConfig netImpairmentDefaults();
+
+/// @brief Simulates a bad network on the receiving side of an ENet host.
+/// Installs itself as the host's intercept callback, holds incoming datagrams
+/// and hands them back to ENet when their simulated arrival time has passed.
+/// Attach one to each side of a connection to impair both directions.
+///
+/// Every random decision comes from a generator seeded by the config, so the
+/// same sequence of datagrams is always dropped, duplicated and reordered the
+/// same way. Delivery times still follow the wall clock.
+class NetworkImpairment {
+private:
+    /// @brief A datagram waiting for its simulated arrival time.
+    struct Datagram {
+        uint64_t deliverAt;           // Delivery time in microseconds of the steady clock.
+        uint64_t sequence;            // Arrival order, keeps equal delivery times FIFO.
+        ENetAddress address;
+        std::vector<enet_uint8> data;
+
+        bool operator>(const Datagram& other) const {
+            return deliverAt != other.deliverAt ? deliverAt > other.deliverAt : sequence > other.sequence;
+        }
+    };
+
+    ENetHost* host;
+    ENetInterceptCallback previousIntercept;   // Runs on each datagram when it is delivered.
+    NetImpairmentConfig config;
+    NetImpairmentStats stats;
+    uint64_t rngState;
+    uint64_t nextSequence;
+    uint64_t linkFreeAt;        // When the simulated link finishes sending what is already queued.
+    uint64_t lastInOrderAt;     // Latest delivery time of a datagram that was not reordered.
+    std::vector<Datagram> pending;   // Min-heap on delivery time.
+
+    static int ENET_CALLBACK interceptCallback(ENetHost* host, void* event);
+
+    double nextRandom();
+    void enqueue(const ENetAddress& address, const enet_uint8* data, size_t length, uint64_t now);
+
+public:
+    /// @brief Starts impairing a host's incoming traffic, replacing (and chaining) its intercept callback.
+    /// @param host The host to impair. Only one impairment can be attached per host.
+    /// @return True if attached, false if the host already has an impairment.
+    bool attach(ENetHost* host);
+
+    /// @brief Restores the host's previous intercept callback and drops held datagrams.
+    void detach();
+
+    /// @brief Delivers every held datagram whose arrival time has passed.
+    /// Call before each enet_host_service; delivered packets show up as events there.
+    /// @return The number of datagrams delivered.
+    int pump();
+
+    /// @brief Gets the simulated conditions.
+    /// @return The current configuration.
+    const NetImpairmentConfig& getConfig() const;
+
+    /// @brief Changes the simulated conditions and reseeds the generator.
+    /// @param config The new configuration.
+    void setConfig(const NetImpairmentConfig& config);
+
+    /// @brief Gets the traffic counters.
+    /// @return The counters since the impairment was created.
+    const NetImpairmentStats& getStats() const;
+
+    /// @brief Gets the number of datagrams currently held.
+    size_t getPendingCount() const;
+
+    explicit NetworkImpairment(const NetImpairmentConfig& config);
+    ~NetworkImpairment();
+
+    NetworkImpairment(const NetworkImpairment&) = delete;
+    NetworkImpairment& operator=(const NetworkImpairment&) = delete;
+};
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "engine.h"
+#include "tilemap.h"
+
+#include <cstdint>
+
+// Messages exchanged between the client and the server. Every message is a
+// plain struct sent as-is, so both sides must be built for the same
+// architecture.
+
+/// @brief Player snapshots from the server; color and movement from clients.
+#define CHANNEL_SNAPSHOT 0
+
+/// @brief Session messages, such as the welcome sent after a client joins.
+#define CHANNEL_CONTROL 1
+
+/// @brief Inventory replication, in both directions. Every message starts with an InventoryMessageType byte.
+#define CHANNEL_INVENTORY 2
+
+/// @brief Chat. Clients send the bare UTF-8 text of one message; the server sends ChatBatches.
+#define CHANNEL_CHAT 3
+
+/// @brief Tile world streaming from the server. Every message starts with a WorldMessageType byte.
+#define CHANNEL_WORLD 4
+
+/// @brief Disconnect data sent when the server shuts down; clients can reconnect right away.
+#define DISCONNECT_REASON_SHUTDOWN 1
+
+/// @brief Player ids start at 1; 0 means "no id".
+#define INVALID_PLAYER_ID 0
+
+/// @brief The first packet a client sends.
+/// Clients that only send a PlayerColor always join as a new player.
+typedef struct {
+    PlayerColor color;       // The color the client picked for a new player.
+    uint32_t resumeId;       // Id from an earlier PlayerWelcome to resume that player, or INVALID_PLAYER_ID.
+    uint64_t resumeToken;    // The resumeToken from the same PlayerWelcome; the id alone is not enough.
+} PlayerHello;
+
+/// @brief Sent by the server on CHANNEL_CONTROL once a client has joined.
+typedef struct {
+    uint32_t playerId;       // Send this as PlayerHello::resumeId to continue as this player after a reconnect.
+    EVec position;           // Where the player spawned, the saved position when resuming.
+    PlayerColor color;       // The player's color, the saved color when resuming.
+    float health;            // The player's health.
+    uint32_t reserved;       // Always 0.
+    uint64_t resumeToken;    // Secret to send as PlayerHello::resumeToken; a new one is issued on every join.
+} PlayerWelcome;
+
+/// @brief Refers to the player's own inventory in inventory messages; world containers have ids from 1.
+#define CONTAINER_PLAYER 0
+
+/// @brief Refers to the player's crafting grid in inventory messages. It is always open.
+#define CONTAINER_CRAFTING 0xFFFFFFFFu
+
+/// @brief The first byte of every message on CHANNEL_INVENTORY.
+typedef enum {
+    INVENTORY_MESSAGE_SYNC = 1,          // Server: every slot of a container, after it is opened.
+    INVENTORY_MESSAGE_DELTA = 2,         // Server: the slots of a container that changed this tick.
+    INVENTORY_MESSAGE_RESULT = 3,        // Server: the outcome of a client's transaction.
+    INVENTORY_MESSAGE_OPEN = 16,         // Client: open a container and get a SYNC; CONTAINER_PLAYER resyncs the own inventory.
+    INVENTORY_MESSAGE_CLOSE = 17,        // Client: stop receiving the open world container; CONTAINER_CRAFTING moves the grid back into the inventory.
+    INVENTORY_MESSAGE_TRANSACTION = 18,  // Client: move items, see InventoryTransaction.
+    INVENTORY_MESSAGE_CRAFT = 19,        // Client: craft from the crafting grid, see InventoryCraftRequest.
+} InventoryMessageType;
+
+/// @brief INVENTORY_MESSAGE_SYNC, followed by rows * cols ItemStacks, row by row.
+typedef struct {
+    uint8_t type;           // INVENTORY_MESSAGE_SYNC
+    uint8_t rows;           // The number of rows in the container.
+    uint8_t cols;           // The number of columns in the container.
+    uint8_t reserved;
+    uint32_t containerId;   // CONTAINER_PLAYER or a world container id.
+} InventorySyncHeader;
+
+/// @brief INVENTORY_MESSAGE_DELTA, followed by slotCount InventorySlotUpdates.
+typedef struct {
+    uint8_t type;           // INVENTORY_MESSAGE_DELTA
+    uint8_t slotCount;      // The number of slot updates that follow.
+    uint16_t reserved;
+    uint32_t containerId;   // CONTAINER_PLAYER or a world container id.
+} InventoryDeltaHeader;
+
+/// @brief The new contents of one slot in an INVENTORY_MESSAGE_DELTA.
+typedef struct {
+    uint8_t slot;           // The slot index.
+    uint8_t reserved;
+    ItemStack stack;        // The slot's new contents.
+} InventorySlotUpdate;
+
+/// @brief INVENTORY_MESSAGE_OPEN or INVENTORY_MESSAGE_CLOSE.
+typedef struct {
+    uint8_t type;           // INVENTORY_MESSAGE_OPEN or INVENTORY_MESSAGE_CLOSE
+    uint8_t reserved[3];
+    uint32_t containerId;   // The container to open, or for CLOSE, CONTAINER_CRAFTING to empty the grid.
+} InventoryContainerRequest;
+
+/// @brief INVENTORY_MESSAGE_TRANSACTION: one InventoryOperation between the player's inventory,
+/// their crafting grid and the open container. The server applies it all-or-nothing, answers with an
+/// InventoryTransactionResult, and sends the changed slots in the same tick's deltas.
+typedef struct {
+    uint8_t type;              // INVENTORY_MESSAGE_TRANSACTION
+    uint8_t operation;         // An InventoryOperation.
+    uint8_t fromSlot;          // The slot the items come from.
+    uint8_t toSlot;            // The slot the items go to.
+    uint32_t fromContainer;    // CONTAINER_PLAYER, CONTAINER_CRAFTING or the open world container.
+    uint32_t toContainer;      // CONTAINER_PLAYER, CONTAINER_CRAFTING or the open world container.
+    uint32_t transactionId;    // Chosen by the client, echoed in the result.
+    uint16_t count;            // The number of items for INVENTORY_SPLIT.
+    uint16_t reserved;
+} InventoryTransaction;
+
+/// @brief INVENTORY_MESSAGE_CRAFT: craft what the crafting grid makes into the player's inventory.
+/// Answered with an InventoryTransactionResult; the grid and inventory changes follow as deltas.
+typedef struct {
+    uint8_t type;              // INVENTORY_MESSAGE_CRAFT
+    uint8_t reserved;
+    uint16_t times;            // The largest number of crafts; fewer are done if the grid or inventory runs out.
+    uint32_t transactionId;    // Chosen by the client, echoed in the result.
+} InventoryCraftRequest;
+
+/// @brief INVENTORY_MESSAGE_RESULT. When a transaction is rejected, the slots it named are
+/// sent again, so a client that predicted the outcome is corrected.
+typedef struct {
+    uint8_t type;              // INVENTORY_MESSAGE_RESULT
+    uint8_t result;            // An InventoryResult.
+    uint16_t reserved;
+    uint32_t transactionId;    // The transaction this answers.
+} InventoryTransactionResult;
+
+/// @brief The longest chat message, in bytes of UTF-8 text.
+#define CHAT_MESSAGE_MAX_LENGTH 200
+
+/// @brief Sent by the server on CHANNEL_CHAT: every message posted during one tick (or the
+/// recent history, right after joining), oldest first. Followed by count entries, each a
+/// ChatEntryHeader and then length bytes of text, with no padding in between.
+typedef struct {
+    uint16_t count;         // The number of entries that follow.
+    uint16_t reserved;
+} ChatBatchHeader;
+
+/// @brief One message in a ChatBatch.
+typedef struct {
+    uint32_t playerId;      // The player who wrote the message.
+    uint16_t length;        // The length of the text that follows, at most CHAT_MESSAGE_MAX_LENGTH.
+    uint16_t reserved;
+} ChatEntryHeader;
+
+/// @brief The first byte of every message on CHANNEL_WORLD.
+typedef enum {
+    WORLD_MESSAGE_CHUNK = 1,     // A chunk near the player, see ChunkDataHeader.
+    WORLD_MESSAGE_UNLOAD = 2,    // Chunks the player moved away from and the client should forget, see ChunkUnloadHeader.
+    WORLD_MESSAGE_TILE = 3,      // A tile changed in a chunk the client holds, see TileUpdate.
+} WorldMessageType;
+
+/// @brief A chunk's tiles. Followed by runCount TileRuns, see Chunk::encode().
+typedef struct {
+    uint8_t type;           // WORLD_MESSAGE_CHUNK
+    uint8_t reserved;
+    uint16_t runCount;
+    ChunkCoord coord;
+} ChunkDataHeader;
+
+/// @brief Chunks to forget. Followed by count ChunkCoords.
+typedef struct {
+    uint8_t type;           // WORLD_MESSAGE_UNLOAD
+    uint8_t reserved;
+    uint16_t count;
+} ChunkUnloadHeader;
+
+/// @brief One changed tile.
+typedef struct {
+    uint8_t type;           // WORLD_MESSAGE_TILE
+    uint8_t reserved;
+    TileId tile;
+    int32_t tileX;
+    int32_t tileY;
+} TileUpdate;
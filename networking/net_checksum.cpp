@@ -0,0 +1,134 @@
+#include "net_checksum.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define NET_CRC32C_HAVE_SSE42 1
+#include <nmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define NET_TARGET_SSE42 __attribute__((target("sse4.2")))
+#else
+#define NET_TARGET_SSE42
+#endif
+
+/// @brief The CRC32C polynomial, bit-reversed.
+#define CRC32C_POLYNOMIAL 0x82F63B78u
+
+namespace {
+
+/// @brief Tables for slicing-by-8: entry [k][b] is the CRC of byte b followed by k zero bytes.
+struct Crc32cTables {
+    std::array<std::array<uint32_t, 256>, 8> table;
+
+    constexpr Crc32cTables() : table() {
+        for (uint32_t byte = 0; byte < 256; ++byte) {
+            uint32_t crc = byte;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+            }
+            table[0][byte] = crc;
+        }
+        for (size_t k = 1; k < 8; ++k) {
+            for (size_t byte = 0; byte < 256; ++byte) {
+                uint32_t previous = table[k - 1][byte];
+                table[k][byte] = (previous >> 8) ^ table[0][previous & 0xFF];
+            }
+        }
+    }
+};
+
+constexpr Crc32cTables crc32cTables;
+
+typedef uint32_t (*Crc32cUpdate)(uint32_t state, const uint8_t* data, size_t length);
+
+uint32_t crc32cUpdateTable(uint32_t state, const uint8_t* data, size_t length) {
+    const auto& t = crc32cTables.table;
+
+    // Eight bytes per step, assembled byte by byte so the result does not depend on endianness.
+    while (length >= 8) {
+        uint32_t low = state ^ (uint32_t(data[0]) | uint32_t(data[1]) << 8 | uint32_t(data[2]) << 16 | uint32_t(data[3]) << 24);
+        uint32_t high = uint32_t(data[4]) | uint32_t(data[5]) << 8 | uint32_t(data[6]) << 16 | uint32_t(data[7]) << 24;
+        state = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+                t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+        data += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        state = (state >> 8) ^ t[0][(state ^ *data++) & 0xFF];
+    }
+    return state;
+}
+
+#ifdef NET_CRC32C_HAVE_SSE42
+NET_TARGET_SSE42 uint32_t crc32cUpdateSse42(uint32_t state, const uint8_t* data, size_t length) {
+    // Align to eight bytes so the main loop does whole-word loads.
+    while (length > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0) {
+        state = _mm_crc32_u8(state, *data++);
+        --length;
+    }
+
+    uint64_t state64 = state;
+    while (length >= 8) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        state64 = _mm_crc32_u64(state64, word);
+        data += 8;
+        length -= 8;
+    }
+    state = uint32_t(state64);
+
+    while (length-- > 0) {
+        state = _mm_crc32_u8(state, *data++);
+    }
+    return state;
+}
+
+bool cpuHasSse42() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+#endif
+
+Crc32cUpdate selectCrc32cUpdate() {
+#ifdef NET_CRC32C_HAVE_SSE42
+    if (cpuHasSse42()) {
+        return &crc32cUpdateSse42;
+    }
+#endif
+    return &crc32cUpdateTable;
+}
+
+const Crc32cUpdate crc32cUpdate = selectCrc32cUpdate();
+
+} // namespace
+
+uint32_t net_crc32c(const void* data, size_t length, uint32_t crc) {
+    return ~crc32cUpdate(~crc, static_cast<const uint8_t*>(data), length);
+}
+
+enet_uint32 net_crc32c_buffers(const ENetBuffer* buffers, size_t bufferCount) {
+    uint32_t state = ~0u;
+    for (size_t i = 0; i < bufferCount; ++i) {
+        state = crc32cUpdate(state, static_cast<const uint8_t*>(buffers[i].data), buffers[i].dataLength);
+    }
+    return ~state;
+}
+
+void net_enable_checksum(ENetHost* host) {
+    host->checksum = &net_crc32c_buffers;
+}
+
+const char* net_crc32c_implementation() {
+    return crc32cUpdate == &crc32cUpdateTable ? "table" : "sse4.2";
+}
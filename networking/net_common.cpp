@@ -2,8 +2,54 @@
 
 #define ENET_IMPLEMENTATION
 #include <enet.h>
+#include "net_common.h"
+#include "profiler.h"
+
+#include <cstddef>
+#include <cstring>
 
 // Any other networking-related code you have here
 struct CommonNetDemo {
     int version;
-};
\ No newline at end of file
+};
+
+bool net_is_connect_datagram(const ENetHost* host, const enet_uint8* data, size_t dataLength) {
+    if (dataLength < offsetof(ENetProtocolHeader, sentTime)) {
+        return false;
+    }
+
+    ENetProtocolHeader header;
+    std::memcpy(&header, data, offsetof(ENetProtocolHeader, sentTime));
+    enet_uint16 peerID = ENET_NET_TO_HOST_16(header.peerID);
+    enet_uint16 flags = peerID & ENET_PROTOCOL_HEADER_FLAG_MASK;
+    peerID &= ~(ENET_PROTOCOL_HEADER_FLAG_MASK | ENET_PROTOCOL_HEADER_SESSION_MASK);
+    if (peerID != ENET_PROTOCOL_MAXIMUM_PEER_ID) {
+        return false;
+    }
+
+    size_t headerSize = (flags & ENET_PROTOCOL_HEADER_FLAG_SENT_TIME) ? sizeof(ENetProtocolHeader) : offsetof(ENetProtocolHeader, sentTime);
+    if (host->checksum != NULL) {
+        headerSize += sizeof(enet_uint32);
+    }
+    if (dataLength < headerSize + sizeof(ENetProtocolCommandHeader)) {
+        return false;
+    }
+    return (data[headerSize] & ENET_PROTOCOL_COMMAND_MASK) == ENET_PROTOCOL_COMMAND_CONNECT;
+}
+
+// Lives in this file because enet_protocol_handle_incoming_commands is only
+// visible inside the ENet implementation.
+int net_inject_datagram(ENetHost* host, const ENetAddress* address, const void* data, size_t dataLength) {
+    PROFILE_FUNCTION();
+    if (dataLength > sizeof(host->packetData[0])) {
+        return -1;
+    }
+
+    std::memcpy(host->packetData[0], data, dataLength);
+    host->receivedAddress = *address;
+    host->receivedData = host->packetData[0];
+    host->receivedDataLength = dataLength;
+
+    // A NULL event makes ENet queue connects and receives for dispatch instead of returning them here.
+    return enet_protocol_handle_incoming_commands(host, NULL) < 0 ? -1 : 0;
+}
@@ -0,0 +1,174 @@
+#include "net_impairment.h"
+#include "net_common.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+
+// The intercept callback only receives the host, so map hosts back to their impairment.
+static std::unordered_map<ENetHost*, NetworkImpairment*> impairedHosts;
+
+static uint64_t nowMicros() {
+    return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+NetImpairmentConfig netImpairmentDefaults() {
+    NetImpairmentConfig config = {};
+    config.queueLimitMs = 1000;
+    config.seed = 1;
+    return config;
+}
+
+NetworkImpairment::NetworkImpairment(const NetImpairmentConfig& config)
+    : host(nullptr), previousIntercept(nullptr), config(config), stats(), rngState(0),
+      nextSequence(0), linkFreeAt(0), lastInOrderAt(0), pending() {
+    setConfig(config);
+}
+
+NetworkImpairment::~NetworkImpairment() {
+    detach();
+}
+
+bool NetworkImpairment::attach(ENetHost* target) {
+    if (host != nullptr || impairedHosts.count(target) != 0) {
+        return false;
+    }
+
+    host = target;
+    previousIntercept = target->intercept;
+    impairedHosts[target] = this;
+    enet_host_set_intercept(target, &NetworkImpairment::interceptCallback);
+    return true;
+}
+
+void NetworkImpairment::detach() {
+    if (host == nullptr) {
+        return;
+    }
+
+    enet_host_set_intercept(host, previousIntercept);
+    impairedHosts.erase(host);
+    host = nullptr;
+    previousIntercept = nullptr;
+    pending.clear();
+}
+
+const NetImpairmentConfig& NetworkImpairment::getConfig() const {
+    return config;
+}
+
+void NetworkImpairment::setConfig(const NetImpairmentConfig& newConfig) {
+    config = newConfig;
+    rngState = newConfig.seed;
+}
+
+const NetImpairmentStats& NetworkImpairment::getStats() const {
+    return stats;
+}
+
+size_t NetworkImpairment::getPendingCount() const {
+    return pending.size();
+}
+
+double NetworkImpairment::nextRandom() {
+    // splitmix64: tiny state and the same sequence on every platform, unlike std:: distributions.
+    uint64_t z = (rngState += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return double(z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+int ENET_CALLBACK NetworkImpairment::interceptCallback(ENetHost* host, void*) {
+    auto it = impairedHosts.find(host);
+    if (it == impairedHosts.end()) {
+        return 0;
+    }
+
+    NetworkImpairment& impairment = *it->second;
+    impairment.enqueue(host->receivedAddress, host->receivedData, host->receivedDataLength, nowMicros());
+    return 1;
+}
+
+void NetworkImpairment::enqueue(const ENetAddress& address, const enet_uint8* data, size_t length, uint64_t now) {
+    stats.received++;
+
+    // Draw every random number up front so each datagram consumes the same amount of the sequence.
+    double lossRoll = nextRandom();
+    double duplicateRoll = nextRandom();
+    double reorderRoll = nextRandom();
+    double jitterRoll = nextRandom();
+
+    if (lossRoll < config.lossRate) {
+        stats.lost++;
+        return;
+    }
+
+    uint64_t departure = now;
+    if (config.bandwidthBytesPerSec > 0) {
+        // The link serializes datagrams one after another; anything that would wait too long is tail dropped.
+        uint64_t start = linkFreeAt > now ? linkFreeAt : now;
+        if (start - now > uint64_t(config.queueLimitMs) * 1000) {
+            stats.overflowed++;
+            return;
+        }
+        linkFreeAt = start + uint64_t(length) * 1000000 / config.bandwidthBytesPerSec;
+        departure = linkFreeAt;
+    }
+
+    int64_t jitter = config.jitterMs > 0 ? int64_t((jitterRoll * 2.0 - 1.0) * config.jitterMs * 1000.0) : 0;
+    int64_t delay = int64_t(config.latencyMs) * 1000 + jitter;
+    uint64_t deliverAt = departure + uint64_t(delay > 0 ? delay : 0);
+
+    if (reorderRoll < config.reorderRate) {
+        stats.reordered++;
+        deliverAt += uint64_t(config.reorderDelayMs) * 1000;
+    } else {
+        // Jitter alone never reorders; only reorderRate does.
+        if (deliverAt < lastInOrderAt) {
+            deliverAt = lastInOrderAt;
+        }
+        lastInOrderAt = deliverAt;
+    }
+
+    int copies = 1;
+    if (duplicateRoll < config.duplicateRate) {
+        stats.duplicated++;
+        copies = 2;
+    }
+
+    for (int i = 0; i < copies; ++i) {
+        pending.push_back(Datagram{deliverAt, nextSequence++, address, std::vector<enet_uint8>(data, data + length)});
+        std::push_heap(pending.begin(), pending.end(), std::greater<Datagram>());
+    }
+}
+
+int NetworkImpairment::pump() {
+    if (host == nullptr) {
+        return 0;
+    }
+    PROFILE_ZONE("NetworkImpairment::pump");
+
+    uint64_t now = nowMicros();
+    int delivered = 0;
+    while (!pending.empty() && pending.front().deliverAt <= now) {
+        std::pop_heap(pending.begin(), pending.end(), std::greater<Datagram>());
+        Datagram datagram = std::move(pending.back());
+        pending.pop_back();
+
+        host->receivedAddress = datagram.address;
+        host->receivedData = datagram.data.data();
+        host->receivedDataLength = datagram.data.size();
+        if (previousIntercept != nullptr && previousIntercept(host, nullptr) != 0) {
+            continue;
+        }
+
+        net_inject_datagram(host, &datagram.address, datagram.data.data(), datagram.data.size());
+        stats.delivered++;
+        delivered++;
+    }
+    return delivered;
+}
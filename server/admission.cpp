@@ -0,0 +1,137 @@
+#include "admission.h"
+#include "net_common.h"
+
+#include <cstring>
+
+std::unordered_map<ENetHost*, ConnectionAdmission*> ConnectionAdmission::attachedHosts;
+
+AdmissionConfig admissionDefaults() {
+    AdmissionConfig config;
+    config.datagramRate = 2000.0f;
+    config.datagramBurst = 500.0f;
+    config.connectRate = 1.0f;
+    config.connectBurst = 4.0f;
+    config.globalConnectRate = 50.0f;
+    config.globalConnectBurst = 100.0f;
+    config.maxPeersPerAddress = 4;
+    return config;
+}
+
+ConnectionAdmission::ConnectionAdmission(MetricsRegistry& metrics)
+    : host(nullptr), acceptingConnections(false), config(admissionDefaults()), addresses(), globalConnects(0, config.globalConnectBurst), lastSweepMs(0),
+      droppedMalformed(metrics.counter("server_admission_dropped_total", "Datagrams dropped before ENet processed them.", "reason=\"malformed\"")),
+      droppedFlood(metrics.counter("server_admission_dropped_total", "Datagrams dropped before ENet processed them.", "reason=\"flood\"")),
+      droppedConnects(metrics.counter("server_admission_dropped_total", "Datagrams dropped before ENet processed them.", "reason=\"connect_rate\"")),
+      trackedAddresses(metrics.gauge("server_admission_tracked_addresses", "Source addresses with rate limit state.")) {
+}
+
+ConnectionAdmission::~ConnectionAdmission() {
+    detach();
+}
+
+bool ConnectionAdmission::attach(ENetHost* target) {
+    if (host != nullptr || attachedHosts.count(target) != 0) {
+        return false;
+    }
+
+    host = target;
+    attachedHosts[target] = this;
+    enet_host_set_intercept(target, &ConnectionAdmission::interceptCallback);
+    configureHost(target);
+    return true;
+}
+
+void ConnectionAdmission::detach() {
+    if (host == nullptr) {
+        return;
+    }
+
+    enet_host_set_intercept(host, nullptr);
+    attachedHosts.erase(host);
+    host = nullptr;
+}
+
+void ConnectionAdmission::setAcceptingConnections(bool accepting) {
+    acceptingConnections = accepting;
+}
+
+int ENET_CALLBACK ConnectionAdmission::interceptCallback(ENetHost* host, void*) {
+    auto it = attachedHosts.find(host);
+    if (it == attachedHosts.end()) {
+        return 0;
+    }
+    return it->second->admit(host) ? 0 : 1;
+}
+
+const AdmissionConfig& ConnectionAdmission::getConfig() const {
+    return config;
+}
+
+void ConnectionAdmission::setConfig(const AdmissionConfig& newConfig) {
+    config = newConfig;
+}
+
+void ConnectionAdmission::configureHost(ENetHost* host) const {
+    host->duplicatePeers = config.maxPeersPerAddress;
+}
+
+void ConnectionAdmission::sweep(uint32_t nowMs) {
+    // Addresses whose buckets have refilled behave exactly like unknown ones, so forget them.
+    std::erase_if(addresses, [&](const auto& pair) {
+        return pair.second.datagrams.isFull(nowMs, config.datagramRate, config.datagramBurst) &&
+               pair.second.connects.isFull(nowMs, config.connectRate, config.connectBurst);
+    });
+    trackedAddresses.set(double(addresses.size()));
+    lastSweepMs = nowMs;
+}
+
+bool ConnectionAdmission::admit(ENetHost* host) {
+    const enet_uint8* data = host->receivedData;
+    size_t length = host->receivedDataLength;
+
+    // Stateless checks first: they cost nothing and reject most junk.
+    if (length < offsetof(ENetProtocolHeader, sentTime)) {
+        droppedMalformed.increment();
+        return false;
+    }
+    ENetProtocolHeader header;
+    std::memcpy(&header, data, offsetof(ENetProtocolHeader, sentTime));
+    enet_uint16 peerID = ENET_NET_TO_HOST_16(header.peerID);
+    peerID &= ~(ENET_PROTOCOL_HEADER_FLAG_MASK | ENET_PROTOCOL_HEADER_SESSION_MASK);
+    if (peerID != ENET_PROTOCOL_MAXIMUM_PEER_ID && peerID >= host->peerCount) {
+        droppedMalformed.increment();
+        return false;
+    }
+
+    uint32_t now = host->serviceTime;
+    if (now - lastSweepMs >= ADMISSION_SWEEP_INTERVAL_MS) {
+        sweep(now);
+    }
+
+    AddressKey key;
+    std::memcpy(&key, &host->receivedAddress.host, sizeof(key));
+    auto it = addresses.find(key);
+    if (it == addresses.end() && addresses.size() < ADMISSION_MAX_TRACKED_ADDRESSES) {
+        it = addresses.emplace(key, AddressState{TokenBucket(now, config.datagramBurst), TokenBucket(now, config.connectBurst)}).first;
+    }
+    // With the table full, untracked addresses are only held back by the global connect bucket.
+
+    if (it != addresses.end() && !it->second.datagrams.take(now, config.datagramRate, config.datagramBurst)) {
+        droppedFlood.increment();
+        return false;
+    }
+
+    if (net_is_connect_datagram(host, data, length)) {
+        // Not counted: refusing connections before the server opens is expected, not an attack.
+        if (!acceptingConnections) {
+            return false;
+        }
+        bool allowed = (it == addresses.end() || it->second.connects.take(now, config.connectRate, config.connectBurst)) &&
+                       globalConnects.take(now, config.globalConnectRate, config.globalConnectBurst);
+        if (!allowed) {
+            droppedConnects.increment();
+            return false;
+        }
+    }
+    return true;
+}
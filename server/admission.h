@@ -0,0 +1,115 @@
+#pragma once
+
+#include <enet.h>
+#include "metrics.h"
+#include "rate_limiter.h"
+
+#include <cstdint>
+#include <unordered_map>
+
+#define ADMISSION_MAX_TRACKED_ADDRESSES 4096
+#define ADMISSION_SWEEP_INTERVAL_MS 1000
+
+/// @brief Limits for connection admission. Rates are per second.
+typedef struct {
+    float datagramRate;          // Datagrams accepted per source address, any kind.
+    float datagramBurst;
+    float connectRate;           // Connection attempts accepted per source address.
+    float connectBurst;
+    float globalConnectRate;     // Connection attempts accepted from all addresses together.
+    float globalConnectBurst;
+    size_t maxPeersPerAddress;   // Applied to host->duplicatePeers.
+} AdmissionConfig;
+
+/// @brief Returns limits suited to real players: a few connects per address, generous traffic.
+AdmissionConfig admissionDefaults();
+
+/// @brief Filters raw datagrams before ENet processes them, from the host's intercept callback.
+///
+/// A stateless pre-filter drops datagrams that cannot be valid (too short,
+/// addressed to a peer slot the host does not have). Then every source address
+/// gets a token bucket for all its datagrams and one for connection attempts,
+/// and all connection attempts share a global bucket, so a connection storm
+/// costs a hash lookup per datagram instead of a peer slot and a handshake.
+/// While the server is not accepting connections, connection attempts are
+/// swallowed without a trace; a refused client keeps retrying until it times out.
+class ConnectionAdmission {
+private:
+    /// @brief The buckets of one source address.
+    struct AddressState {
+        TokenBucket datagrams;
+        TokenBucket connects;
+    };
+
+    /// @brief IPv6 address (IPv4 is mapped) as two words for hashing.
+    struct AddressKey {
+        uint64_t high;
+        uint64_t low;
+
+        bool operator==(const AddressKey& other) const {
+            return high == other.high && low == other.low;
+        }
+    };
+
+    struct AddressKeyHash {
+        size_t operator()(const AddressKey& key) const {
+            return size_t(key.high * 0x9E3779B97F4A7C15ull ^ key.low);
+        }
+    };
+
+    /// @brief The intercept callback only receives the host, so map hosts back to their admission.
+    static std::unordered_map<ENetHost*, ConnectionAdmission*> attachedHosts;
+
+    ENetHost* host;
+    bool acceptingConnections;
+    AdmissionConfig config;
+    std::unordered_map<AddressKey, AddressState, AddressKeyHash> addresses;
+    TokenBucket globalConnects;
+    uint32_t lastSweepMs;
+
+    Counter& droppedMalformed;
+    Counter& droppedFlood;
+    Counter& droppedConnects;
+    Gauge& trackedAddresses;
+
+    void sweep(uint32_t nowMs);
+
+    static int ENET_CALLBACK interceptCallback(ENetHost* host, void* event);
+
+public:
+    /// @brief Starts filtering a host's incoming datagrams and applies the per-address peer limit.
+    /// @param host The server host. Only one admission can be attached per host.
+    /// @return True if attached, false if this admission or the host is already attached.
+    bool attach(ENetHost* host);
+
+    /// @brief Stops filtering the attached host's datagrams. Call before destroying the host.
+    void detach();
+
+    /// @brief Lets connection attempts through, or swallows them all.
+    /// @param accepting True once the server is open for clients.
+    void setAcceptingConnections(bool accepting);
+
+    /// @brief Decides whether the datagram the host just received may be processed.
+    /// @param host The host, with receivedAddress/receivedData set by ENet.
+    /// @return True to let ENet process the datagram, false to drop it.
+    bool admit(ENetHost* host);
+
+    /// @brief Applies the per-address peer limit to a host.
+    /// @param host The server host.
+    void configureHost(ENetHost* host) const;
+
+    /// @brief Gets the current limits.
+    const AdmissionConfig& getConfig() const;
+
+    /// @brief Changes the limits. Call configureHost() again to update the peer limit.
+    void setConfig(const AdmissionConfig& config);
+
+    /// @brief Creates the admission filter and its drop counters.
+    /// @param metrics Registry for the counters.
+    explicit ConnectionAdmission(MetricsRegistry& metrics);
+
+    ~ConnectionAdmission();
+
+    ConnectionAdmission(const ConnectionAdmission&) = delete;
+    ConnectionAdmission& operator=(const ConnectionAdmission&) = delete;
+};
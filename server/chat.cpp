@@ -0,0 +1,79 @@
+#include "chat.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cstring>
+
+ChatRelay::ChatRelay(MetricsRegistry& metrics)
+    : history(), postedCount(0), flushedCount(0),
+      messagesTotal(metrics.counter("server_chat_messages_total", "Chat messages relayed to players.")),
+      droppedRate(metrics.counter("server_chat_dropped_total", "Chat messages dropped instead of relayed.", "reason=\"rate\"")),
+      droppedInvalid(metrics.counter("server_chat_dropped_total", "Chat messages dropped instead of relayed.", "reason=\"invalid\"")),
+      droppedOverflow(metrics.counter("server_chat_dropped_total", "Chat messages dropped instead of relayed.", "reason=\"overflow\"")) {
+}
+
+bool ChatRelay::post(uint32_t playerId, TokenBucket& tokens, uint32_t nowMs, const enet_uint8* text, size_t length) {
+    if (length == 0 || length > CHAT_MESSAGE_MAX_LENGTH ||
+        std::any_of(text, text + length, [](enet_uint8 c) { return c < 0x20 || c == 0x7F; })) {
+        droppedInvalid.increment();
+        return false;
+    }
+    if (!tokens.take(nowMs, CHAT_RATE_PER_SECOND, CHAT_BURST)) {
+        droppedRate.increment();
+        return false;
+    }
+
+    Entry& entry = history[postedCount % CHAT_HISTORY_CAPACITY];
+    entry.playerId = playerId;
+    entry.length = uint16_t(length);
+    std::memcpy(entry.text, text, length);
+    ++postedCount;
+    return true;
+}
+
+ENetPacket* ChatRelay::createBatch(uint64_t first, uint64_t end) const {
+    // Only the last CHAT_HISTORY_CAPACITY posts are intact, flushed or not; older slots were reused.
+    first = std::max(first, postedCount > CHAT_HISTORY_CAPACITY ? postedCount - CHAT_HISTORY_CAPACITY : 0);
+    if (first >= end) {
+        return nullptr;
+    }
+
+    size_t size = sizeof(ChatBatchHeader);
+    for (uint64_t i = first; i < end; ++i) {
+        size += sizeof(ChatEntryHeader) + history[i % CHAT_HISTORY_CAPACITY].length;
+    }
+
+    ENetPacket* packet = enet_packet_create(NULL, size, ENET_PACKET_FLAG_RELIABLE);
+    if (packet == nullptr) {
+        return nullptr;
+    }
+    ChatBatchHeader header = {uint16_t(end - first), 0};
+    std::memcpy(packet->data, &header, sizeof(header));
+    size_t offset = sizeof(header);
+    for (uint64_t i = first; i < end; ++i) {
+        const Entry& entry = history[i % CHAT_HISTORY_CAPACITY];
+        ChatEntryHeader entryHeader = {entry.playerId, entry.length, 0};
+        std::memcpy(packet->data + offset, &entryHeader, sizeof(entryHeader));
+        std::memcpy(packet->data + offset + sizeof(entryHeader), entry.text, entry.length);
+        offset += sizeof(entryHeader) + entry.length;
+    }
+    return packet;
+}
+
+ENetPacket* ChatRelay::takeBatch() {
+    uint64_t pending = postedCount - flushedCount;
+    if (pending > CHAT_HISTORY_CAPACITY) {
+        // The ring wrapped within one tick; the oldest messages were overwritten before anyone got them.
+        droppedOverflow.increment(pending - CHAT_HISTORY_CAPACITY);
+        GAME_LOG_WARNING("Dropped %llu chat messages posted in one tick", (unsigned long long)(pending - CHAT_HISTORY_CAPACITY));
+    }
+
+    ENetPacket* packet = createBatch(flushedCount, postedCount);
+    messagesTotal.increment(std::min<uint64_t>(pending, CHAT_HISTORY_CAPACITY));
+    flushedCount = postedCount;
+    return packet;
+}
+
+ENetPacket* ChatRelay::createHistoryBatch() const {
+    return createBatch(0, flushedCount);
+}
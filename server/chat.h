@@ -0,0 +1,69 @@
+#pragma once
+
+#include <enet.h>
+#include "metrics.h"
+#include "protocol.h"
+#include "rate_limiter.h"
+
+#include <array>
+#include <cstdint>
+
+/// @brief The number of recent messages kept for players who join later.
+/// Also the most messages one tick can carry; older ones of a busier tick are dropped.
+#define CHAT_HISTORY_CAPACITY 128
+
+/// @brief Chat messages each player may send per second, and in one burst.
+#define CHAT_RATE_PER_SECOND 2.0f
+#define CHAT_BURST 5.0f
+
+/// @brief Collects chat messages and hands them out in batches.
+///
+/// Messages go into a fixed ring of fixed-size slots, which is also the history
+/// sent to players who join later, so posting never allocates. Once per tick the
+/// messages posted since the last flush become one packet, which the server queues
+/// for every player: a busy tick costs one packet per recipient, not one per
+/// message per recipient.
+class ChatRelay {
+private:
+    /// @brief A ring slot.
+    struct Entry {
+        uint32_t playerId;
+        uint16_t length;
+        char text[CHAT_MESSAGE_MAX_LENGTH];
+    };
+
+    std::array<Entry, CHAT_HISTORY_CAPACITY> history;
+    uint64_t postedCount;    // Messages ever posted; the next one goes to slot postedCount % capacity.
+    uint64_t flushedCount;   // Messages already handed out by takeBatch().
+
+    Counter& messagesTotal;
+    Counter& droppedRate;
+    Counter& droppedInvalid;
+    Counter& droppedOverflow;
+
+    /// @brief Creates a batch of the messages with sequence numbers in [first, end).
+    ENetPacket* createBatch(uint64_t first, uint64_t end) const;
+
+public:
+    /// @brief Accepts a message from a player if they are within their rate limit and the text is valid.
+    /// @param playerId The player who wrote the message.
+    /// @param tokens The player's chat rate limit.
+    /// @param nowMs The current time in milliseconds.
+    /// @param text The message text, UTF-8 without control characters.
+    /// @param length The length of the text, 1 to CHAT_MESSAGE_MAX_LENGTH bytes.
+    /// @return True if the message will go out with the next batch.
+    bool post(uint32_t playerId, TokenBucket& tokens, uint32_t nowMs, const enet_uint8* text, size_t length);
+
+    /// @brief Creates the batch of messages posted since the last call.
+    /// @return A new reliable packet to queue for every player, or nullptr if nothing was posted.
+    ENetPacket* takeBatch();
+
+    /// @brief Creates a batch of the recent messages that were already handed out, for a player who just joined.
+    /// Messages posted since the last flush take history slots, so a busy tick shortens the history.
+    /// @return A new reliable packet, or nullptr if there is no history.
+    ENetPacket* createHistoryBatch() const;
+
+    /// @brief Constructs an empty relay.
+    /// @param metrics The registry for the message counters.
+    explicit ChatRelay(MetricsRegistry& metrics);
+};
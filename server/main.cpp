@@ -1,104 +1,77 @@
-#include <enet.h>
-#include "engine.h"
-#include <iostream>
-#include <unordered_map>
-#include <vector>
+#include "server.h"
+#include "crafting.h"
+#include "item_registry.h"
+#include "logger.h"
+#include "profiler.h"
+#include "metrics_endpoint.h"
+
 #include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <string>
 #include <thread>
 
-#define SERVER_PORT 6777
-#define SLEEP_MS 10
+#define PROFILER_TRACE_PATH "server_trace.json"
+#define PROFILER_DUMP_INTERVAL_S 10
 
-struct PlayerInfo {
-    EVec position;
-    PlayerColor color;
-};
+GameServer server;
 
-std::unordered_map<ENetPeer*, PlayerInfo> players;  // Map of connected players and their states
+/// @brief Set by SIGINT/SIGTERM; the main loop shuts the server down when it sees it.
+static volatile std::sig_atomic_t shutdownRequested = 0;
 
-ENetHost* server;
+static void RequestShutdown(int) {
+    shutdownRequested = 1;
+}
 
-void StartServer();
 void ProcessPackets();
-void StopServer();
 
 int main() {
-    StartServer();
-
-    while (true) {
-        ProcessPackets();
-
-        ENetEvent event;
-        while (enet_host_service(server, &event, 0) > 0) {
-            if (event.type == ENET_EVENT_TYPE_CONNECT) {
-                char ip[INET6_ADDRSTRLEN];
-                enet_address_get_host_ip(&event.peer->address, ip, sizeof(ip));
-                std::cout << "A new client connected from " << ip << ":" << event.peer->address.port << std::endl;
-
-                players[event.peer] = PlayerInfo{{960.0f, 540.0f}};  // Start at a default position
-            } else if (event.type == ENET_EVENT_TYPE_RECEIVE) {
-                if (players.find(event.peer) == players.end()) {
-                    // This is the first packet from this client, and it should contain the player's color
-                    PlayerColor* receivedColor = (PlayerColor*)event.packet->data;
-                    players[event.peer].color = *receivedColor;
-                    std::cout << "Received color from client: " << (int)receivedColor->r << ", "
-                            << (int)receivedColor->g << ", " << (int)receivedColor->b << std::endl;
-                } else {
-                    // Handle movement updates
-                    EVec* receivedMovementDelta = (EVec*)event.packet->data;
-                    PlayerInfo& playerInfo = players[event.peer];
-                    playerInfo.position.x += receivedMovementDelta->x;
-                    playerInfo.position.y += receivedMovementDelta->y;
-                }
-
-                enet_packet_destroy(event.packet);
-            } else if (event.type == ENET_EVENT_TYPE_DISCONNECT) {
-                std::cout << "Client disconnected." << std::endl;
-                players.erase(event.peer);  // Remove the player from the map
-            }
-        }
-
-        // Broadcast all player positions to all clients
-        for (auto& pair : players) {
-            ENetPeer* peer = pair.first;
-            std::vector<std::pair<EVec, PlayerColor>> playerData;
-
-            for (auto& player : players) {
-                playerData.push_back({player.second.position, player.second.color});
-            }
+    // Items must be known before the world is loaded, old saves refer to them by name.
+    std::string itemError;
+    if (!ItemRegistry::getInstance().loadFromFile(ITEM_REGISTRY_PATH, itemError)) {
+        GAME_LOG_CRITICAL("Failed to load item definitions: %s", itemError.c_str());
+        return EXIT_FAILURE;
+    }
+    if (!RecipeBook::getInstance().loadFromFile(RECIPE_BOOK_PATH, ItemRegistry::getInstance(), itemError)) {
+        GAME_LOG_CRITICAL("Failed to load recipes: %s", itemError.c_str());
+        return EXIT_FAILURE;
+    }
 
-            ENetPacket* packet = enet_packet_create(playerData.data(), playerData.size() * sizeof(std::pair<EVec, PlayerColor>), ENET_PACKET_FLAG_RELIABLE);
-            enet_peer_send(peer, 0, packet);
-        }
+    // The host exists while STARTING but refuses connects until the world is loaded.
+    if (!server.Start() || !server.OpenWorld() || !server.Open()) {
+        server.Stop();
+        return EXIT_FAILURE;
     }
 
-    StopServer();
-    return 0;
-}
+    std::signal(SIGINT, RequestShutdown);
+    std::signal(SIGTERM, RequestShutdown);
 
-void StartServer() {
-    if (enet_initialize() != 0) {
-        std::cerr << "An error occurred while initializing ENet." << std::endl;
-        exit(EXIT_FAILURE);
-    }
+    // Metrics are optional, keep running if the port is taken.
+    MetricsEndpoint metricsEndpoint(server.getMetrics());
+    metricsEndpoint.Start();
+
+#ifdef ENABLE_PROFILING
+    // Keep a rolling capture of the last zones on disk for post-mortem analysis.
+    auto nextTraceDump = std::chrono::steady_clock::now() + std::chrono::seconds(PROFILER_DUMP_INTERVAL_S);
+#endif
 
-    ENetAddress address;
-    address.host = ENET_HOST_ANY;
-    address.port = SERVER_PORT;
+    while (!shutdownRequested) {
+        ProcessPackets();
 
-    server = enet_host_create(&address, 32, 2, 0, 0);
+        server.Tick();
+        metricsEndpoint.poll();
 
-    if (server == NULL) {
-        std::cerr << "An error occurred while trying to create an ENet server host." << std::endl;
-        exit(EXIT_FAILURE);
+#ifdef ENABLE_PROFILING
+        if (std::chrono::steady_clock::now() >= nextTraceDump) {
+            Profiler::getInstance().writeChromeTrace(PROFILER_TRACE_PATH);
+            nextTraceDump += std::chrono::seconds(PROFILER_DUMP_INTERVAL_S);
+        }
+#endif
     }
 
-    std::cout << "Server started on port " << SERVER_PORT << "." << std::endl;
-}
-
-void StopServer() {
-    enet_host_destroy(server);
-    enet_deinitialize();
+    metricsEndpoint.Stop();
+    server.Shutdown();
+    return 0;
 }
 
 void ProcessPackets() {
@@ -0,0 +1,135 @@
+#include "metrics_endpoint.h"
+#include "logger.h"
+
+#include <cerrno>
+
+MetricsEndpoint::MetricsEndpoint(MetricsRegistry& registry) : registry(registry), listener(ENET_SOCKET_NULL), connections() {
+}
+
+MetricsEndpoint::~MetricsEndpoint() {
+    Stop();
+}
+
+bool MetricsEndpoint::Start(enet_uint16 port, const char* bindAddress) {
+    ENetAddress address;
+    if (enet_address_set_host(&address, bindAddress) != 0) {
+        GAME_LOG_ERROR("Invalid metrics bind address: %s", bindAddress);
+        return false;
+    }
+    address.port = port;
+
+    listener = enet_socket_create(ENET_SOCKET_TYPE_STREAM);
+    if (listener == ENET_SOCKET_NULL) {
+        GAME_LOG_ERROR("Failed to create the metrics socket.");
+        return false;
+    }
+    enet_socket_set_option(listener, ENET_SOCKOPT_REUSEADDR, 1);
+    enet_socket_set_option(listener, ENET_SOCKOPT_NONBLOCK, 1);
+
+    if (enet_socket_bind(listener, &address) != 0 || enet_socket_listen(listener, METRICS_MAX_CONNECTIONS) != 0) {
+        GAME_LOG_ERROR("Failed to listen for metrics scrapes on %s:%u", bindAddress, (unsigned)port);
+        enet_socket_destroy(listener);
+        listener = ENET_SOCKET_NULL;
+        return false;
+    }
+
+    GAME_LOG_INFO("Serving metrics on %s:%u", bindAddress, (unsigned)port);
+    return true;
+}
+
+void MetricsEndpoint::Stop() {
+    for (Connection& connection : connections) {
+        enet_socket_destroy(connection.socket);
+    }
+    connections.clear();
+
+    if (listener != ENET_SOCKET_NULL) {
+        enet_socket_destroy(listener);
+        listener = ENET_SOCKET_NULL;
+    }
+}
+
+void MetricsEndpoint::poll() {
+    if (listener == ENET_SOCKET_NULL) {
+        return;
+    }
+
+    while (connections.size() < METRICS_MAX_CONNECTIONS) {
+        ENetSocket socket = enet_socket_accept(listener, NULL);
+        if (socket == ENET_SOCKET_NULL) {
+            break;
+        }
+        enet_socket_set_option(socket, ENET_SOCKOPT_NONBLOCK, 1);
+        connections.push_back(Connection{socket, enet_time_get() + METRICS_CONNECTION_TIMEOUT_MS, {}, {}, 0});
+    }
+
+    std::erase_if(connections, [this](Connection& connection) {
+        if (advance(connection) && !ENET_TIME_GREATER_EQUAL(enet_time_get(), connection.deadline)) {
+            return false;
+        }
+        enet_socket_shutdown(connection.socket, ENET_SOCKET_SHUTDOWN_READ_WRITE);
+        enet_socket_destroy(connection.socket);
+        return true;
+    });
+}
+
+/// @brief Reads from a non-blocking stream socket. enet_socket_receive() returns 0 both when
+/// nothing is waiting and when the peer closed the connection; this tells the two apart.
+/// @param closed Set to true if the peer closed the connection.
+/// @return The number of bytes read (0 if none), or -1 on error.
+static int receiveStream(ENetSocket socket, char* buffer, size_t size, bool& closed) {
+#ifdef _WIN32
+    int received = recv(socket, buffer, int(size), 0);
+    if (received == SOCKET_ERROR) {
+        return WSAGetLastError() == WSAEWOULDBLOCK ? 0 : -1;
+    }
+#else
+    ssize_t received = recv(socket, buffer, size, MSG_NOSIGNAL);
+    if (received < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+    }
+#endif
+    closed = received == 0;
+    return int(received);
+}
+
+// Returns whether the connection should stay open.
+bool MetricsEndpoint::advance(Connection& connection) {
+    if (connection.response.empty()) {
+        char buffer[1024];
+        bool closed = false;
+        int received;
+        while ((received = receiveStream(connection.socket, buffer, sizeof(buffer), closed)) > 0) {
+            connection.request.append(buffer, size_t(received));
+        }
+        if (received < 0) {
+            return false;
+        }
+        if (connection.request.find("\r\n\r\n") == std::string::npos) {
+            // Still waiting for the rest of the headers; give up on oversized requests, and right
+            // away on peers that closed, instead of holding their slot until the deadline.
+            return !closed && connection.request.size() < sizeof(buffer) * 8;
+        }
+
+        std::string body = registry.renderPrometheus();
+        connection.response = "HTTP/1.0 200 OK\r\n"
+                              "Content-Type: text/plain; version=0.0.4\r\n"
+                              "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                              "Connection: close\r\n\r\n" + body;
+    }
+
+    while (connection.sent < connection.response.size()) {
+        ENetBuffer data;
+        data.data = connection.response.data() + connection.sent;
+        data.dataLength = connection.response.size() - connection.sent;
+        int sent = enet_socket_send(connection.socket, NULL, &data, 1);
+        if (sent < 0) {
+            return false;
+        }
+        if (sent == 0) {
+            return true;  // Socket buffer full, continue next poll.
+        }
+        connection.sent += size_t(sent);
+    }
+    return false;  // Response complete.
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <enet.h>
+#include "metrics.h"
+
+#include <string>
+#include <vector>
+
+#define SERVER_METRICS_PORT 9777
+#define METRICS_MAX_CONNECTIONS 8
+#define METRICS_CONNECTION_TIMEOUT_MS 1000
+
+/// @brief Serves a MetricsRegistry over plain HTTP so Prometheus (or curl) can scrape it.
+/// Uses a non-blocking ENet stream socket and is driven by poll() from the
+/// server loop, so it needs no thread of its own. Every request is answered
+/// with the full metrics text, regardless of the path.
+class MetricsEndpoint {
+private:
+    /// @brief A scrape in progress.
+    struct Connection {
+        ENetSocket socket;
+        enet_uint32 deadline;    // enet_time_get() after which the connection is dropped.
+        std::string request;     // Bytes read so far, until the end of the headers.
+        std::string response;    // Empty until the request is complete.
+        size_t sent;             // Bytes of response already sent.
+    };
+
+    MetricsRegistry& registry;
+    ENetSocket listener;
+    std::vector<Connection> connections;
+
+    bool advance(Connection& connection);
+
+public:
+    /// @brief Starts listening.
+    /// @param port The TCP port.
+    /// @param bindAddress The address to bind, loopback by default so metrics stay local.
+    /// @return True if the socket is listening.
+    bool Start(enet_uint16 port = SERVER_METRICS_PORT, const char* bindAddress = "127.0.0.1");
+
+    /// @brief Accepts new scrapes and makes progress on open ones without blocking.
+    void poll();
+
+    /// @brief Closes the listener and every open connection.
+    void Stop();
+
+    explicit MetricsEndpoint(MetricsRegistry& registry);
+    ~MetricsEndpoint();
+
+    MetricsEndpoint(const MetricsEndpoint&) = delete;
+    MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+};
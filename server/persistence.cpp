@@ -0,0 +1,430 @@
+#include "persistence.h"
+#include "logger.h"
+#include "mapped_file.h"
+#include "profiler.h"
+#include "protocol.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define PERSIST_RECORD_PLAYER_NAMED_ITEMS 1   // Inventory items stored by name; only read, for worlds saved before item ids.
+#define PERSIST_RECORD_PLAYER_NO_TOKEN 2      // Without a resume token; only read, such players can no longer be resumed.
+#define PERSIST_RECORD_PLAYER 3
+
+/// @brief Header in front of every record in the snapshot and the log.
+typedef struct {
+    uint32_t length;     // Payload length in bytes.
+    uint32_t checksum;   // FNV-1a of the payload, catches torn and corrupted writes.
+} PersistRecordHeader;
+
+/// @brief Header at the start of the snapshot file.
+typedef struct {
+    uint32_t magic;      // PERSIST_SNAPSHOT_MAGIC
+    uint32_t version;    // PERSIST_SNAPSHOT_VERSION
+} PersistSnapshotHeader;
+
+static uint32_t fnv1a(const unsigned char* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static bool syncFile(FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+template <typename T> static void put(std::vector<unsigned char>& out, const T& value) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+/// @brief Reads fields back out of a record payload; every read fails once one has run past the end.
+class RecordReader {
+private:
+    const unsigned char* data;
+    size_t size;
+    size_t offset;
+
+public:
+    RecordReader(const unsigned char* data, size_t size) : data(data), size(size), offset(0) {}
+
+    template <typename T> bool get(T& value) {
+        if (size - offset < sizeof(T)) {
+            offset = size;
+            return false;
+        }
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string& value, size_t length) {
+        if (size - offset < length) {
+            offset = size;
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(data + offset), length);
+        offset += length;
+        return true;
+    }
+};
+
+static void appendPlayerRecord(std::vector<unsigned char>& out, const PlayerRecord& record) {
+    size_t start = out.size();
+    put(out, PersistRecordHeader{});
+
+    put(out, uint8_t(PERSIST_RECORD_PLAYER));
+    put(out, record.id);
+    put(out, record.position);
+    put(out, record.color);
+    put(out, record.health);
+    put(out, record.resumeToken);
+    put(out, uint8_t(record.inventory.getRows()));
+    put(out, uint8_t(record.inventory.getCols()));
+    for (int i = 0; i < record.inventory.getSlotCount(); ++i) {
+        put(out, record.inventory.getSlot(i));
+    }
+
+    size_t payloadStart = start + sizeof(PersistRecordHeader);
+    PersistRecordHeader header = {uint32_t(out.size() - payloadStart), fnv1a(out.data() + payloadStart, out.size() - payloadStart)};
+    std::memcpy(out.data() + start, &header, sizeof(header));
+}
+
+static bool readPlayerFields(RecordReader& reader, PlayerRecord& record) {
+    return reader.get(record.id) && reader.get(record.position) && reader.get(record.color) && reader.get(record.health);
+}
+
+static bool readPlayerRecord(RecordReader& reader, PlayerRecord& record, bool hasResumeToken) {
+    uint8_t rows, cols;
+    if (!readPlayerFields(reader, record) || (hasResumeToken && !reader.get(record.resumeToken)) || !reader.get(rows) || !reader.get(cols)) {
+        return false;
+    }
+
+    record.inventory = Inventory(rows, cols);
+    if (record.inventory.getSlotCount() != int(rows) * int(cols)) {
+        return false;
+    }
+    for (int i = 0; i < record.inventory.getSlotCount(); ++i) {
+        ItemStack stack;
+        if (!reader.get(stack)) {
+            return false;
+        }
+        record.inventory.setSlot(i, stack);
+    }
+    return true;
+}
+
+/// @brief Reads a record from before item ids, looking the item names up in the item registry.
+static bool readNamedItemsPlayerRecord(RecordReader& reader, PlayerRecord& record) {
+    int32_t rows, cols;
+    uint32_t itemCount;
+    if (!readPlayerFields(reader, record) || !reader.get(rows) || !reader.get(cols) || !reader.get(itemCount)) {
+        return false;
+    }
+
+    const ItemRegistry& registry = ItemRegistry::getInstance();
+    record.inventory = Inventory(rows, cols);
+    for (uint32_t i = 0; i < itemCount; ++i) {
+        std::string name;
+        uint16_t nameLength;
+        int32_t maxStackSize, amount;
+        if (!reader.get(nameLength) || !reader.getString(name, nameLength) || !reader.get(maxStackSize) || !reader.get(amount)) {
+            return false;
+        }
+        ItemId id = registry.findId(name);
+        if (id == ITEM_NONE || int(i) >= record.inventory.getSlotCount()) {
+            GAME_LOG_WARNING("Dropping %d '%s' from player %u: no such item or no room.", int(amount), name.c_str(), record.id);
+            continue;
+        }
+        record.inventory.setSlot(int(i), ItemStack{id, uint16_t(std::clamp(int(amount), 0, int(registry.getMaxStackSize(id))))});
+    }
+    return true;
+}
+
+/// @brief Applies every intact record in a buffer, in order.
+/// @return The number of bytes that held intact records; anything after that is torn or corrupt.
+static size_t readRecords(const unsigned char* data, size_t size, std::unordered_map<uint32_t, PlayerRecord>& players) {
+    size_t offset = 0;
+    while (size - offset >= sizeof(PersistRecordHeader)) {
+        PersistRecordHeader header;
+        std::memcpy(&header, data + offset, sizeof(header));
+        const unsigned char* payload = data + offset + sizeof(header);
+        if (size - offset - sizeof(header) < header.length || fnv1a(payload, header.length) != header.checksum) {
+            break;
+        }
+
+        RecordReader reader(payload, header.length);
+        uint8_t type;
+        PlayerRecord record{INVALID_PLAYER_ID, 0, {}, {}, 0.0f, Inventory(0, 0), TokenBucket(0, 0.0f)};
+        if (!reader.get(type)) {
+            break;
+        }
+        bool read = false;
+        if (type == PERSIST_RECORD_PLAYER || type == PERSIST_RECORD_PLAYER_NO_TOKEN) {
+            read = readPlayerRecord(reader, record, type == PERSIST_RECORD_PLAYER);
+        } else if (type == PERSIST_RECORD_PLAYER_NAMED_ITEMS) {
+            read = readNamedItemsPlayerRecord(reader, record);
+        }
+        if (!read) {
+            break;
+        }
+        players.insert_or_assign(record.id, std::move(record));
+        offset += sizeof(header) + header.length;
+    }
+    return offset;
+}
+
+WorldPersistence::WorldPersistence()
+    : directory(), opened(false), staged(), committed(), committedBatches(0), writtenBatches(0), stopping(false),
+      world(), logFile(nullptr), logBytes(0), logMissesRecords(false) {
+}
+
+WorldPersistence::~WorldPersistence() {
+    close();
+}
+
+bool WorldPersistence::isOpen() const {
+    return opened;
+}
+
+bool WorldPersistence::open(const std::string& worldDirectory, std::unordered_map<uint32_t, PlayerRecord>& players) {
+    auto startTime = std::chrono::steady_clock::now();
+    directory = worldDirectory;
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    std::filesystem::path snapshotPath = std::filesystem::path(directory) / PERSIST_SNAPSHOT_FILE;
+    std::filesystem::path logPath = std::filesystem::path(directory) / PERSIST_LOG_FILE;
+
+    players.clear();
+    if (std::filesystem::file_size(snapshotPath, ec) > 0 && !ec) {
+        MappedFile snapshot;
+        PersistSnapshotHeader header;
+        if (!snapshot.open(snapshotPath.string()) || snapshot.size() < sizeof(header)) {
+            GAME_LOG_CRITICAL("Failed to read world snapshot: %s", snapshotPath.string().c_str());
+            return false;
+        }
+        std::memcpy(&header, snapshot.data(), sizeof(header));
+        if (header.magic != PERSIST_SNAPSHOT_MAGIC || header.version != PERSIST_SNAPSHOT_VERSION) {
+            GAME_LOG_CRITICAL("Unsupported world snapshot: %s", snapshotPath.string().c_str());
+            return false;
+        }
+        size_t size = snapshot.size() - sizeof(header);
+        if (readRecords(snapshot.data() + sizeof(header), size, players) != size) {
+            GAME_LOG_WARNING("World snapshot has a corrupt record, ignoring everything after it.");
+        }
+    }
+
+    size_t logSize = size_t(std::filesystem::file_size(logPath, ec));
+    if (ec) {
+        logSize = 0;
+    }
+    size_t validLogSize = 0;
+    if (logSize > 0) {
+        MappedFile log;
+        if (!log.open(logPath.string())) {
+            GAME_LOG_CRITICAL("Failed to read world log: %s", logPath.string().c_str());
+            return false;
+        }
+        validLogSize = readRecords(log.data(), log.size(), players);
+    }
+    if (validLogSize < logSize) {
+        // The tail was being written when the server stopped; drop it so new records follow intact ones.
+        GAME_LOG_WARNING("Discarding %zu torn bytes at the end of the world log.", logSize - validLogSize);
+        std::filesystem::resize_file(logPath, validLogSize, ec);
+    }
+
+    logFile = std::fopen(logPath.string().c_str(), "ab");
+    if (logFile == nullptr) {
+        GAME_LOG_CRITICAL("Failed to open world log for writing: %s", logPath.string().c_str());
+        return false;
+    }
+    logBytes = validLogSize;
+    logMissesRecords = false;
+    world = players;
+
+    stopping = false;
+    opened = true;
+    writer = std::thread(&WorldPersistence::writerLoop, this);
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    GAME_LOG_INFO("Loaded %zu players from %s in %.2f ms.", players.size(), directory.c_str(), elapsedMs);
+    return true;
+}
+
+void WorldPersistence::close() {
+    if (!opened) {
+        return;
+    }
+
+    commit();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeWriter.notify_one();
+    writer.join();
+
+    if (logFile != nullptr) {
+        std::fclose(logFile);
+        logFile = nullptr;
+    }
+    opened = false;
+}
+
+void WorldPersistence::stage(PlayerRecord record) {
+    staged.push_back(std::move(record));
+}
+
+void WorldPersistence::commit() {
+    if (staged.empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (committed.empty()) {
+            // Swapping hands the writer the staged buffer and keeps the old one's capacity for the tick.
+            committed.swap(staged);
+        } else {
+            std::move(staged.begin(), staged.end(), std::back_inserter(committed));
+            staged.clear();
+        }
+        committedBatches++;
+    }
+    wakeWriter.notify_one();
+}
+
+void WorldPersistence::flush() {
+    commit();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = committedBatches;
+    batchWritten.wait(lock, [&] { return writtenBatches >= target; });
+}
+
+void WorldPersistence::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeWriter.wait(lock, [this] { return stopping || !committed.empty(); });
+        if (committed.empty()) {
+            return;  // Stopping with nothing left to write.
+        }
+
+        std::vector<PlayerRecord> batch;
+        batch.swap(committed);
+        uint64_t batchId = committedBatches;
+        lock.unlock();
+
+        {
+            PROFILE_ZONE("WorldPersistence::write");
+            if (!appendToLog(batch)) {
+                GAME_LOG_ERROR("Failed to append to the world log.");
+                logMissesRecords = true;
+            }
+            for (PlayerRecord& record : batch) {
+                world.insert_or_assign(record.id, std::move(record));
+            }
+            // Only a snapshot can save records the log could not take; retry it with every batch until it succeeds.
+            if (logMissesRecords || logBytes >= PERSIST_COMPACT_BYTES) {
+                if (writeSnapshot()) {
+                    logMissesRecords = false;
+                } else {
+                    GAME_LOG_ERROR("Failed to write the world snapshot.");
+                }
+            }
+        }
+
+        lock.lock();
+        writtenBatches = batchId;
+        batchWritten.notify_all();
+    }
+}
+
+bool WorldPersistence::appendToLog(const std::vector<PlayerRecord>& batch) {
+    if (logFile == nullptr) {
+        // Reopening after a failed compaction.
+        logFile = std::fopen((std::filesystem::path(directory) / PERSIST_LOG_FILE).string().c_str(), "ab");
+        if (logFile == nullptr) {
+            return false;
+        }
+    }
+
+    std::vector<unsigned char> buffer;
+    for (const PlayerRecord& record : batch) {
+        appendPlayerRecord(buffer, record);
+    }
+
+    bool written = std::fwrite(buffer.data(), 1, buffer.size(), logFile) == buffer.size();
+    if (syncFile(logFile) && written) {
+        logBytes += buffer.size();
+        return true;
+    }
+
+    // Part of the batch may have reached the file. Cut it off, or every record appended
+    // after it would be unreadable; the next append reopens the log.
+    std::fclose(logFile);
+    logFile = nullptr;
+    std::error_code ec;
+    std::filesystem::resize_file(std::filesystem::path(directory) / PERSIST_LOG_FILE, logBytes, ec);
+    if (ec) {
+        GAME_LOG_ERROR("Failed to cut a torn record off the world log: %s", ec.message().c_str());
+    }
+    return false;
+}
+
+bool WorldPersistence::writeSnapshot() {
+    std::filesystem::path snapshotPath = std::filesystem::path(directory) / PERSIST_SNAPSHOT_FILE;
+    std::filesystem::path temporaryPath = snapshotPath;
+    temporaryPath += ".tmp";
+    std::filesystem::path logPath = std::filesystem::path(directory) / PERSIST_LOG_FILE;
+
+    std::vector<unsigned char> buffer;
+    put(buffer, PersistSnapshotHeader{PERSIST_SNAPSHOT_MAGIC, PERSIST_SNAPSHOT_VERSION});
+    for (const auto& pair : world) {
+        appendPlayerRecord(buffer, pair.second);
+    }
+
+    FILE* file = std::fopen(temporaryPath.string().c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    written = syncFile(file) && written;
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        return false;
+    }
+
+    // The rename is atomic, so a crash leaves either the old or the new snapshot. If it
+    // happens before the log is truncated, replaying the log again is harmless.
+    std::error_code ec;
+    std::filesystem::rename(temporaryPath, snapshotPath, ec);
+    if (ec) {
+        return false;
+    }
+
+    if (logFile != nullptr) {
+        std::fclose(logFile);
+    }
+    logFile = std::fopen(logPath.string().c_str(), "wb");
+    logBytes = 0;
+    return logFile != nullptr;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "engine.h"
+#include "rate_limiter.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#define PERSIST_SNAPSHOT_FILE "world.snapshot"
+#define PERSIST_LOG_FILE "world.log"
+#define PERSIST_SNAPSHOT_MAGIC 0x5357434Eu   // "NCWS" in little endian
+#define PERSIST_SNAPSHOT_VERSION 1
+
+/// @brief The log is compacted into a new snapshot once it grows past this many bytes.
+#define PERSIST_COMPACT_BYTES (4 * 1024 * 1024)
+
+/// @brief The saved state of one player.
+struct PlayerRecord {
+    uint32_t id;           // Persistent player id.
+    uint64_t resumeToken;  // The secret a client must send to resume the player; 0 if it cannot be resumed.
+    EVec position;         // Last known position.
+    PlayerColor color;     // The player's color.
+    float health;          // The player's health.
+    Inventory inventory;   // The player's inventory.
+    TokenBucket chatTokens{0, 0.0f};   // Not written to disk, so reconnecting does not refill it; empty after a restart.
+};
+
+/// @brief Saves player state to disk without blocking the server tick.
+///
+/// The world lives in two files in one directory: a snapshot holding every
+/// player, and an append-only log of player records written since the
+/// snapshot. On open, the snapshot is loaded and the log replayed over it; a
+/// torn record at the end of the log (from a crash mid-write) is cut off.
+///
+/// The tick stages copies of changed players and commits them, which only
+/// swaps a vector under a lock. A background thread appends committed
+/// records to the log and, once the log is large enough, writes a compacted
+/// snapshot and truncates the log. A failed append is cut off the log as
+/// well, and the records it held are saved by writing a snapshot instead.
+class WorldPersistence {
+private:
+    std::string directory;
+    bool opened;
+
+    // Owned by the tick thread.
+    std::vector<PlayerRecord> staged;
+
+    // Shared between the tick and the writer, guarded by mutex.
+    std::mutex mutex;
+    std::condition_variable wakeWriter;
+    std::condition_variable batchWritten;
+    std::vector<PlayerRecord> committed;
+    uint64_t committedBatches;
+    uint64_t writtenBatches;
+    bool stopping;
+
+    // Owned by the writer thread.
+    std::unordered_map<uint32_t, PlayerRecord> world;   // Latest record of every player, for compaction.
+    FILE* logFile;
+    size_t logBytes;          // Length of the intact records in the log.
+    bool logMissesRecords;    // An append failed, so the log lacks records only a snapshot can save.
+    std::thread writer;
+
+    void writerLoop();
+    bool appendToLog(const std::vector<PlayerRecord>& batch);
+    bool writeSnapshot();
+
+public:
+    /// @brief Loads the world from a directory and starts the writer thread.
+    /// The directory is created if it does not exist.
+    /// @param directory The directory holding the world files.
+    /// @param players Receives every saved player, keyed by id.
+    /// @return True if the world was loaded (or is new) and can be written.
+    bool open(const std::string& directory, std::unordered_map<uint32_t, PlayerRecord>& players);
+
+    /// @brief Writes everything committed so far, then stops the writer thread.
+    void close();
+
+    /// @brief Checks whether a world is open.
+    bool isOpen() const;
+
+    /// @brief Queues a copy of a player to be saved by the next commit().
+    /// @param record The player's current state.
+    void stage(PlayerRecord record);
+
+    /// @brief Hands every staged record to the writer thread. Never waits for disk.
+    void commit();
+
+    /// @brief Commits, then waits until everything committed so far is on disk.
+    void flush();
+
+    WorldPersistence();
+    ~WorldPersistence();
+
+    WorldPersistence(const WorldPersistence&) = delete;
+    WorldPersistence& operator=(const WorldPersistence&) = delete;
+};
@@ -0,0 +1,855 @@
+#include "server.h"
+#include "batch_kernels.h"
+#include "logger.h"
+#include "profiler.h"
+#include "net_checksum.h"
+#include "net_common.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+GameServer::GameServer()
+    : host(nullptr), players(), savedPlayers(), persistence(), nextPlayerId(INVALID_PLAYER_ID + 1), tickNumber(0), state(STARTING), metrics(),
+      tickSeconds(metrics.histogram("server_tick_seconds", "Time spent in one server tick.",
+                                    {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1})),
+      ticksTotal(metrics.counter("server_ticks_total", "Server ticks run.")),
+      sentBytesTotal(metrics.counter("server_sent_bytes_total", "UDP payload bytes sent.")),
+      sentPacketsTotal(metrics.counter("server_sent_packets_total", "UDP datagrams sent.")),
+      receivedBytesTotal(metrics.counter("server_received_bytes_total", "UDP payload bytes received.")),
+      receivedPacketsTotal(metrics.counter("server_received_packets_total", "UDP datagrams received.")),
+      connectedPeers(metrics.gauge("server_connected_peers", "Peers in the connected state.")),
+      playerCount(metrics.gauge("server_players", "Players in the world.")),
+      admission(metrics), containers(), nextContainerId(CONTAINER_PLAYER + 1),
+      inventoryTransactionsAccepted(metrics.counter("server_inventory_transactions_total", "Inventory transactions from clients.", "result=\"accepted\"")),
+      inventoryTransactionsRejected(metrics.counter("server_inventory_transactions_total", "Inventory transactions from clients.", "result=\"rejected\"")),
+      chat(metrics) {
+}
+
+bool GameServer::SetState(ServerState next) {
+    bool allowed = (state == STARTING && next != STARTING) || (state == OPEN && next == CLOSING);
+    if (!allowed) {
+        GAME_LOG_ERROR("Invalid server state transition %d -> %d.", (int)state, (int)next);
+        return false;
+    }
+    state = next;
+    admission.setAcceptingConnections(state == OPEN);
+    return true;
+}
+
+bool GameServer::OpenWorld(const std::string& directory) {
+    if (state != STARTING) {
+        GAME_LOG_ERROR("The world can only be opened while the server is starting.");
+        return false;
+    }
+    if (!persistence.open(directory, savedPlayers)) {
+        return false;
+    }
+
+    for (const auto& pair : savedPlayers) {
+        nextPlayerId = std::max(nextPlayerId, pair.first + 1);
+    }
+    return true;
+}
+
+bool GameServer::Start(enet_uint16 port) {
+    if (enet_initialize() != 0) {
+        GAME_LOG_CRITICAL("An error occurred while initializing ENet.");
+        return false;
+    }
+
+    ENetAddress address;
+    address.host = ENET_HOST_ANY;
+    address.port = port;
+
+    host = enet_host_create(&address, SERVER_MAX_CLIENTS, SERVER_CHANNEL_COUNT, 0, 0);
+
+    if (host == NULL) {
+        GAME_LOG_CRITICAL("An error occurred while trying to create an ENet server host.");
+        enet_deinitialize();
+        return false;
+    }
+
+    // Clients enable the same checksum; a datagram that fails it is dropped before any command is read.
+    net_enable_checksum(host);
+
+    admission.attach(host);
+
+    GAME_LOG_INFO("Server started on port %u (crc32c: %s).", (unsigned)port, net_crc32c_implementation());
+    return true;
+}
+
+bool GameServer::Open() {
+    if (host == nullptr || !SetState(OPEN)) {
+        return false;
+    }
+
+    // Warm up: size the per-player containers for a full server so joins never rehash mid-tick.
+    players.reserve(SERVER_MAX_CLIENTS);
+    peerMetrics.reserve(SERVER_MAX_CLIENTS);
+
+    GAME_LOG_INFO("Server is open for clients.");
+    return true;
+}
+
+void GameServer::Stop() {
+    if (persistence.isOpen()) {
+        for (auto& pair : players) {
+            if (pair.second.id != INVALID_PLAYER_ID) {
+                EmptyCraftingGrid(pair.second);
+                persistence.stage(ToRecord(pair.second));
+            }
+        }
+        persistence.close();
+    }
+
+    if (host != nullptr) {
+        admission.detach();
+        enet_host_destroy(host);
+        host = nullptr;
+        enet_deinitialize();
+    }
+    players.clear();
+}
+
+/// @brief Counts peers that are connected or still going through the disconnect handshake.
+static size_t CountActivePeers(const ENetHost* host) {
+    size_t active = 0;
+    for (size_t i = 0; i < host->peerCount; ++i) {
+        active += host->peers[i].state != ENET_PEER_STATE_DISCONNECTED ? 1 : 0;
+    }
+    return active;
+}
+
+void GameServer::Shutdown(enet_uint32 drainTimeoutMs) {
+    if (host == nullptr) {
+        return;
+    }
+
+    GAME_LOG_INFO("Shutting down, disconnecting %zu peers.", host->connectedPeers);
+    SetState(CLOSING);
+
+    // The disconnect is queued behind each peer's outgoing packets, so they are flushed first.
+    for (size_t i = 0; i < host->peerCount; ++i) {
+        ENetPeer* peer = &host->peers[i];
+        if (peer->state != ENET_PEER_STATE_DISCONNECTED && peer->state != ENET_PEER_STATE_ZOMBIE) {
+            enet_peer_disconnect(peer, DISCONNECT_REASON_SHUTDOWN);
+        }
+    }
+
+    // Disconnect events save and remove their player; keep servicing until every peer is gone.
+    enet_uint32 deadline = enet_time_get() + drainTimeoutMs;
+    ENetEvent event;
+    while (CountActivePeers(host) > 0 && ENET_TIME_LESS(enet_time_get(), deadline)) {
+        if (enet_host_service(host, &event, 10) > 0) {
+            HandleEvent(event);
+        }
+    }
+
+    size_t remaining = CountActivePeers(host);
+    if (remaining > 0) {
+        GAME_LOG_WARNING("%zu peers did not acknowledge the disconnect in time.", remaining);
+        for (size_t i = 0; i < host->peerCount; ++i) {
+            if (host->peers[i].state != ENET_PEER_STATE_DISCONNECTED) {
+                enet_peer_reset(&host->peers[i]);
+            }
+        }
+    }
+
+    // Players whose disconnect was not acknowledged are still in the map and are saved by Stop().
+    Stop();
+    GAME_LOG_INFO("Server stopped.");
+}
+
+void GameServer::Tick() {
+    PROFILE_ZONE("Tick");
+    auto tickStart = std::chrono::steady_clock::now();
+
+    {
+        // Includes sending whatever the previous tick queued
+        PROFILE_ZONE("ServiceHost");
+        ENetEvent event;
+        while (enet_host_service(host, &event, 0) > 0) {
+            HandleEvent(event);
+        }
+    }
+
+    IntegrateMovement();
+    ResolveCollisions();
+    StreamChunks();
+    ReplicateInventories();
+    FlushChat();
+    BroadcastPlayerStates();
+    SampleMetrics();
+
+    ++tickNumber;
+    if (persistence.isOpen() && tickNumber % PERSIST_INTERVAL_TICKS == 0) {
+        CheckpointPlayers();
+    }
+    if (tickNumber % CHUNK_CACHE_IDLE_TICKS == 0) {
+        world.evictUnusedSince(tickNumber - CHUNK_CACHE_IDLE_TICKS);
+    }
+
+    ticksTotal.increment();
+    tickSeconds.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - tickStart).count());
+}
+
+std::string GameServer::PeerLabels(const ENetPeer* peer) {
+    return "peer=\"" + std::to_string(peer->incomingPeerID) + "\"";
+}
+
+void GameServer::SampleMetrics() {
+    PROFILE_FUNCTION();
+
+    // ENet's totals are 32 bits and meant to be reset by the user, so drain them into 64-bit counters.
+    sentBytesTotal.increment(host->totalSentData);
+    sentPacketsTotal.increment(host->totalSentPackets);
+    receivedBytesTotal.increment(host->totalReceivedData);
+    receivedPacketsTotal.increment(host->totalReceivedPackets);
+    host->totalSentData = host->totalSentPackets = host->totalReceivedData = host->totalReceivedPackets = 0;
+
+    connectedPeers.set(double(host->connectedPeers));
+    playerCount.set(double(players.size()));
+
+    for (auto& [peer, gauges] : peerMetrics) {
+        gauges.roundTripTime->set(peer->roundTripTime);
+        gauges.roundTripTimeVariance->set(peer->roundTripTimeVariance);
+        gauges.packetLoss->set(double(peer->packetLoss) / double(ENET_PEER_PACKET_LOSS_SCALE));
+        gauges.packetsLost->set(peer->totalPacketsLost);
+        gauges.packetThrottle->set(double(peer->packetThrottle) / double(ENET_PEER_PACKET_THROTTLE_SCALE));
+        gauges.reliableDataInTransit->set(peer->reliableDataInTransit);
+        gauges.outgoingReliableCommands->set(double(enet_list_size(&peer->outgoingReliableCommands)));
+        gauges.outgoingUnreliableCommands->set(double(enet_list_size(&peer->outgoingUnreliableCommands)));
+        gauges.sentReliableCommands->set(double(enet_list_size(&peer->sentReliableCommands)));
+    }
+}
+
+PeerMetrics GameServer::CreatePeerMetrics(const ENetPeer* peer) {
+    std::string labels = PeerLabels(peer);
+    return PeerMetrics{
+        &metrics.gauge("peer_round_trip_time_ms", "Mean round trip time of reliable packets.", labels),
+        &metrics.gauge("peer_round_trip_time_variance_ms", "Round trip time variance.", labels),
+        &metrics.gauge("peer_packet_loss_ratio", "Mean reliable packet loss.", labels),
+        &metrics.gauge("peer_packets_lost", "Reliable packets lost during the session.", labels),
+        &metrics.gauge("peer_packet_throttle_ratio", "Current unreliable packet throttle.", labels),
+        &metrics.gauge("peer_reliable_data_in_transit_bytes", "Reliable bytes sent but not acknowledged.", labels),
+        &metrics.gauge("peer_outgoing_reliable_commands", "Reliable commands queued for sending.", labels),
+        &metrics.gauge("peer_outgoing_unreliable_commands", "Unreliable commands queued for sending.", labels),
+        &metrics.gauge("peer_sent_reliable_commands", "Reliable commands waiting for acknowledgement.", labels),
+    };
+}
+
+void GameServer::HandleEvent(ENetEvent& event) {
+    PROFILE_FUNCTION();
+    if (event.type == ENET_EVENT_TYPE_CONNECT) {
+        char ip[INET6_ADDRSTRLEN];
+        enet_address_get_host_ip(&event.peer->address, ip, sizeof(ip));
+        if (state != OPEN) {
+            // Finished a handshake that started before the server began closing.
+            enet_peer_disconnect(event.peer, DISCONNECT_REASON_SHUTDOWN);
+            return;
+        }
+        GAME_LOG_INFO("A new client connected from %s:%u", ip, event.peer->address.port);
+
+        players[event.peer] = PlayerInfo{};  // Start at a default position
+        peerMetrics[event.peer] = CreatePeerMetrics(event.peer);
+    } else if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+        auto it = players.find(event.peer);
+        if (it != players.end()) {
+            PlayerInfo& playerInfo = it->second;
+            if (event.channelID == CHANNEL_INVENTORY) {
+                if (playerInfo.id != INVALID_PLAYER_ID) {
+                    HandleInventoryMessage(event.peer, playerInfo, event.packet);
+                }
+            } else if (event.channelID == CHANNEL_CHAT) {
+                if (playerInfo.id != INVALID_PLAYER_ID) {
+                    chat.post(playerInfo.id, playerInfo.chatTokens, enet_time_get(), event.packet->data, event.packet->dataLength);
+                }
+            } else if (!playerInfo.hasColor) {
+                // This is the first packet from this client, and it should contain the player's color
+                if (event.packet->dataLength >= sizeof(PlayerColor)) {
+                    JoinPlayer(event.peer, playerInfo, event.packet);
+                }
+            } else if (event.packet->dataLength >= sizeof(EVec)) {
+                // Handle movement updates; the float delta is rounded once, then simulated in fixed point by IntegrateMovement.
+                EVec delta;
+                std::memcpy(&delta, event.packet->data, sizeof(delta));
+                playerInfo.movementInputs.push_back(toFixed<WorldFixed>(delta));
+            }
+        }
+
+        enet_packet_destroy(event.packet);
+    } else if (event.type == ENET_EVENT_TYPE_DISCONNECT) {
+        GAME_LOG_INFO("Client disconnected.");
+        auto it = players.find(event.peer);
+        if (it != players.end()) {
+            CloseContainer(event.peer, it->second);
+            EmptyCraftingGrid(it->second);
+        }
+        if (it != players.end() && it->second.id != INVALID_PLAYER_ID) {
+            // Keep the player around so the client can resume it after reconnecting.
+            PlayerRecord record = ToRecord(it->second);
+            if (persistence.isOpen()) {
+                persistence.stage(record);
+                persistence.commit();
+            }
+            savedPlayers.insert_or_assign(record.id, std::move(record));
+        }
+        players.erase(event.peer);  // Remove the player from the map
+        peerMetrics.erase(event.peer);
+        metrics.removeLabels(PeerLabels(event.peer));
+    }
+}
+
+/// @brief Creates a resume token. Player ids are sequential and easy to guess, so resuming also needs this secret.
+/// It comes from std::random_device rather than Random, whose output can be predicted from earlier output.
+static uint64_t CreateResumeToken() {
+    std::random_device randomDevice;
+    uint64_t token = 0;
+    while (token == 0) {
+        token = uint64_t(randomDevice()) << 32 | uint64_t(randomDevice());
+    }
+    return token;
+}
+
+void GameServer::JoinPlayer(ENetPeer* peer, PlayerInfo& playerInfo, const ENetPacket* packet) {
+    PlayerHello hello = {};
+    std::memcpy(&hello, packet->data, std::min(packet->dataLength, sizeof(hello)));
+
+    // A saved player can only be resumed by one peer at a time; offline players live in savedPlayers only.
+    auto saved = savedPlayers.find(hello.resumeId);
+    bool resuming = packet->dataLength >= sizeof(PlayerHello) && saved != savedPlayers.end();
+    if (resuming && (saved->second.resumeToken == 0 || saved->second.resumeToken != hello.resumeToken)) {
+        GAME_LOG_WARNING("Refused to resume player %u: wrong resume token.", hello.resumeId);
+        resuming = false;
+    }
+    if (resuming) {
+        PlayerRecord& record = saved->second;
+        playerInfo.id = record.id;
+        playerInfo.position = clampToWorld(toFixed<WorldFixed>(record.position));
+        playerInfo.color = record.color;
+        playerInfo.health = record.health;
+        playerInfo.inventory = std::move(record.inventory);
+        playerInfo.chatTokens = record.chatTokens;
+        savedPlayers.erase(saved);
+        GAME_LOG_INFO("Player %u resumed.", playerInfo.id);
+    } else {
+        playerInfo.id = nextPlayerId++;
+        playerInfo.color = hello.color;
+        playerInfo.chatTokens = TokenBucket(enet_time_get(), CHAT_BURST);
+        GAME_LOG_INFO("Player %u joined with color: %d, %d, %d", playerInfo.id,
+                (int)hello.color.r, (int)hello.color.g, (int)hello.color.b);
+    }
+    playerInfo.hasColor = true;
+    playerInfo.dirty = true;
+    // A new token per join, so one seen in an earlier session is of no use.
+    playerInfo.resumeToken = CreateResumeToken();
+
+    PlayerWelcome welcome = {playerInfo.id, toFloat(playerInfo.position), playerInfo.color, playerInfo.health, 0, playerInfo.resumeToken};
+    ENetPacket* welcomePacket = enet_packet_create(&welcome, sizeof(welcome), ENET_PACKET_FLAG_RELIABLE);
+    if (enet_peer_send(peer, CHANNEL_CONTROL, welcomePacket) != 0) {
+        enet_packet_destroy(welcomePacket);
+    }
+
+    // The only full inventory syncs until the client asks for one; after this it gets deltas.
+    OpenContainer(peer, playerInfo, CONTAINER_PLAYER);
+    OpenContainer(peer, playerInfo, CONTAINER_CRAFTING);
+
+    // Messages posted earlier this tick are not in the history yet; they arrive with the tick's batch.
+    ENetPacket* history = chat.createHistoryBatch();
+    if (history != nullptr && enet_peer_send(peer, CHANNEL_CHAT, history) != 0) {
+        enet_packet_destroy(history);
+    }
+}
+
+/// @brief Queues a packet on CHANNEL_INVENTORY, destroying it if it could not be queued.
+static void SendInventoryPacket(ENetPeer* peer, ENetPacket* packet) {
+    if (enet_peer_send(peer, CHANNEL_INVENTORY, packet) != 0) {
+        enet_packet_destroy(packet);
+    }
+}
+
+void GameServer::HandleInventoryMessage(ENetPeer* peer, PlayerInfo& playerInfo, const ENetPacket* packet) {
+    PROFILE_FUNCTION();
+    if (packet->dataLength == 0) {
+        return;
+    }
+
+    switch (packet->data[0]) {
+    case INVENTORY_MESSAGE_OPEN:
+    case INVENTORY_MESSAGE_CLOSE: {
+        if (packet->dataLength < sizeof(InventoryContainerRequest)) {
+            return;
+        }
+        InventoryContainerRequest request;
+        std::memcpy(&request, packet->data, sizeof(request));
+        if (request.type == INVENTORY_MESSAGE_OPEN) {
+            OpenContainer(peer, playerInfo, request.containerId);
+        } else if (request.containerId == CONTAINER_CRAFTING) {
+            EmptyCraftingGrid(playerInfo);
+        } else {
+            CloseContainer(peer, playerInfo);
+        }
+        break;
+    }
+    case INVENTORY_MESSAGE_TRANSACTION: {
+        if (packet->dataLength < sizeof(InventoryTransaction)) {
+            return;
+        }
+        InventoryTransaction transaction;
+        std::memcpy(&transaction, packet->data, sizeof(transaction));
+        ApplyInventoryTransaction(peer, playerInfo, transaction);
+        break;
+    }
+    case INVENTORY_MESSAGE_CRAFT: {
+        if (packet->dataLength < sizeof(InventoryCraftRequest)) {
+            return;
+        }
+        InventoryCraftRequest request;
+        std::memcpy(&request, packet->data, sizeof(request));
+        CraftFromGrid(peer, playerInfo, request);
+        break;
+    }
+    default:
+        GAME_LOG_DEBUG("Ignoring inventory message of type %d from player %u.", (int)packet->data[0], playerInfo.id);
+        break;
+    }
+}
+
+void GameServer::ApplyInventoryTransaction(ENetPeer* peer, PlayerInfo& playerInfo, const InventoryTransaction& transaction) {
+    Inventory* from = FindOpenInventory(playerInfo, transaction.fromContainer);
+    Inventory* to = FindOpenInventory(playerInfo, transaction.toContainer);
+
+    InventoryResult result = INVENTORY_NOT_OPEN;
+    if (from != nullptr && to != nullptr) {
+        result = applyInventoryOperation(InventoryOperation(transaction.operation), *from, transaction.fromSlot, *to, transaction.toSlot,
+                                         transaction.count, ItemRegistry::getInstance());
+    }
+
+    if (result == INVENTORY_OK) {
+        inventoryTransactionsAccepted.increment();
+        playerInfo.dirty = true;
+    } else {
+        inventoryTransactionsRejected.increment();
+        // Send the real contents again in case the client already showed the move.
+        if (from != nullptr && transaction.fromSlot < from->getSlotCount()) {
+            from->markSlotDirty(transaction.fromSlot);
+        }
+        if (to != nullptr && transaction.toSlot < to->getSlotCount()) {
+            to->markSlotDirty(transaction.toSlot);
+        }
+    }
+
+    InventoryTransactionResult reply = {INVENTORY_MESSAGE_RESULT, uint8_t(result), 0, transaction.transactionId};
+    SendInventoryPacket(peer, enet_packet_create(&reply, sizeof(reply), ENET_PACKET_FLAG_RELIABLE));
+}
+
+void GameServer::CraftFromGrid(ENetPeer* peer, PlayerInfo& playerInfo, const InventoryCraftRequest& request) {
+    const RecipeBook& book = RecipeBook::getInstance();
+    playerInfo.craftingPreview.update(playerInfo.craftingGrid, playerInfo.craftingGrid.getDirtySlots(), book);
+
+    InventoryResult result = INVENTORY_NO_RECIPE;
+    if (playerInfo.craftingPreview.getRecipeIndex() != RECIPE_NONE) {
+        int crafted = playerInfo.craftingPreview.craft(playerInfo.craftingGrid, playerInfo.inventory, request.times, book,
+                                                       ItemRegistry::getInstance());
+        result = crafted > 0 ? INVENTORY_OK : INVENTORY_NO_ROOM;
+    }
+
+    if (result == INVENTORY_OK) {
+        inventoryTransactionsAccepted.increment();
+        playerInfo.dirty = true;
+    } else {
+        inventoryTransactionsRejected.increment();
+    }
+
+    InventoryTransactionResult reply = {INVENTORY_MESSAGE_RESULT, uint8_t(result), 0, request.transactionId};
+    SendInventoryPacket(peer, enet_packet_create(&reply, sizeof(reply), ENET_PACKET_FLAG_RELIABLE));
+}
+
+void GameServer::EmptyCraftingGrid(PlayerInfo& playerInfo) {
+    const ItemRegistry& registry = ItemRegistry::getInstance();
+    for (int i = 0; i < playerInfo.craftingGrid.getSlotCount(); ++i) {
+        ItemStack stack = playerInfo.craftingGrid.getSlot(i);
+        if (stack.id != ITEM_NONE) {
+            // Whatever does not fit stays in the grid, and is lost if the player leaves.
+            int left = playerInfo.inventory.add(stack.id, stack.count, registry);
+            playerInfo.craftingGrid.setSlot(i, ItemStack{stack.id, uint16_t(left)});
+            playerInfo.dirty = true;
+            if (left > 0) {
+                GAME_LOG_WARNING("%d items in player %u's crafting grid do not fit their inventory.", left, playerInfo.id);
+            }
+        }
+    }
+}
+
+Inventory* GameServer::FindOpenInventory(PlayerInfo& playerInfo, uint32_t containerId) {
+    if (containerId == CONTAINER_PLAYER) {
+        return &playerInfo.inventory;
+    }
+    if (containerId == CONTAINER_CRAFTING) {
+        return &playerInfo.craftingGrid;
+    }
+    if (containerId != playerInfo.openContainer) {
+        return nullptr;
+    }
+    return getContainerInventory(containerId);
+}
+
+void GameServer::OpenContainer(ENetPeer* peer, PlayerInfo& playerInfo, uint32_t containerId) {
+    if (containerId == CONTAINER_PLAYER) {
+        // The sync holds every slot, so pending deltas of the own inventory are redundant.
+        SendInventoryPacket(peer, CreateInventorySyncPacket(CONTAINER_PLAYER, playerInfo.inventory));
+        playerInfo.inventory.clearDirtySlots();
+        return;
+    }
+    if (containerId == CONTAINER_CRAFTING) {
+        SendInventoryPacket(peer, CreateInventorySyncPacket(CONTAINER_CRAFTING, playerInfo.craftingGrid));
+        playerInfo.craftingPreview.update(playerInfo.craftingGrid, playerInfo.craftingGrid.getDirtySlots(), RecipeBook::getInstance());
+        playerInfo.craftingGrid.clearDirtySlots();
+        return;
+    }
+
+    auto it = containers.find(containerId);
+    if (it == containers.end()) {
+        GAME_LOG_DEBUG("Player %u tried to open missing container %u.", playerInfo.id, containerId);
+        return;
+    }
+    if (playerInfo.openContainer != containerId) {
+        CloseContainer(peer, playerInfo);
+        it->second.viewers.push_back(peer);
+        playerInfo.openContainer = containerId;
+    }
+    // Other viewers still need the pending deltas, so they are not cleared here.
+    SendInventoryPacket(peer, CreateInventorySyncPacket(containerId, it->second.inventory));
+}
+
+void GameServer::CloseContainer(ENetPeer* peer, PlayerInfo& playerInfo) {
+    auto it = containers.find(playerInfo.openContainer);
+    if (it != containers.end()) {
+        std::vector<ENetPeer*>& viewers = it->second.viewers;
+        viewers.erase(std::remove(viewers.begin(), viewers.end(), peer), viewers.end());
+    }
+    playerInfo.openContainer = CONTAINER_PLAYER;
+}
+
+ENetPacket* GameServer::CreateInventorySyncPacket(uint32_t containerId, const Inventory& inventory) {
+    size_t slotCount = size_t(inventory.getSlotCount());
+    ENetPacket* packet = enet_packet_create(NULL, sizeof(InventorySyncHeader) + slotCount * sizeof(ItemStack), ENET_PACKET_FLAG_RELIABLE);
+
+    InventorySyncHeader header = {INVENTORY_MESSAGE_SYNC, uint8_t(inventory.getRows()), uint8_t(inventory.getCols()), 0, containerId};
+    std::memcpy(packet->data, &header, sizeof(header));
+    for (size_t i = 0; i < slotCount; ++i) {
+        ItemStack stack = inventory.getSlot(int(i));
+        std::memcpy(packet->data + sizeof(header) + i * sizeof(ItemStack), &stack, sizeof(stack));
+    }
+    return packet;
+}
+
+ENetPacket* GameServer::CreateInventoryDeltaPacket(uint32_t containerId, const Inventory& inventory) {
+    uint64_t dirty = inventory.getDirtySlots();
+    size_t updateCount = size_t(std::popcount(dirty));
+    ENetPacket* packet = enet_packet_create(NULL, sizeof(InventoryDeltaHeader) + updateCount * sizeof(InventorySlotUpdate), ENET_PACKET_FLAG_RELIABLE);
+
+    InventoryDeltaHeader header = {INVENTORY_MESSAGE_DELTA, uint8_t(updateCount), 0, containerId};
+    std::memcpy(packet->data, &header, sizeof(header));
+    enet_uint8* out = packet->data + sizeof(header);
+    for (; dirty != 0; dirty &= dirty - 1) {
+        int slot = std::countr_zero(dirty);
+        InventorySlotUpdate update = {uint8_t(slot), 0, inventory.getSlot(slot)};
+        std::memcpy(out, &update, sizeof(update));
+        out += sizeof(update);
+    }
+    return packet;
+}
+
+void GameServer::ReplicateInventories() {
+    PROFILE_FUNCTION();
+    for (auto& [peer, playerInfo] : players) {
+        if (playerInfo.id == INVALID_PLAYER_ID) {
+            continue;
+        }
+        if (playerInfo.inventory.getDirtySlots() != 0) {
+            SendInventoryPacket(peer, CreateInventoryDeltaPacket(CONTAINER_PLAYER, playerInfo.inventory));
+            playerInfo.inventory.clearDirtySlots();
+        }
+        if (playerInfo.craftingGrid.getDirtySlots() != 0) {
+            // The preview catches up with the changed slots before they are forgotten.
+            playerInfo.craftingPreview.update(playerInfo.craftingGrid, playerInfo.craftingGrid.getDirtySlots(), RecipeBook::getInstance());
+            SendInventoryPacket(peer, CreateInventoryDeltaPacket(CONTAINER_CRAFTING, playerInfo.craftingGrid));
+            playerInfo.craftingGrid.clearDirtySlots();
+        }
+    }
+
+    for (auto& [containerId, container] : containers) {
+        if (container.inventory.getDirtySlots() == 0) {
+            continue;
+        }
+        if (!container.viewers.empty()) {
+            // One packet shared by every viewer; ENet frees it once the last one has sent it.
+            ENetPacket* packet = CreateInventoryDeltaPacket(containerId, container.inventory);
+            for (ENetPeer* viewer : container.viewers) {
+                enet_peer_send(viewer, CHANNEL_INVENTORY, packet);
+            }
+            if (packet->referenceCount == 0) {
+                enet_packet_destroy(packet);
+            }
+        }
+        container.inventory.clearDirtySlots();
+    }
+}
+
+void GameServer::IntegrateMovement() {
+    PROFILE_FUNCTION();
+    // Each round applies the next input of every player that has one left, so one player's
+    // inputs still apply in the order they arrived. Usually there is a single round.
+    for (size_t round = 0;; ++round) {
+        movers.clear();
+        moverPositions.clear();
+        moverInputs.clear();
+        for (auto& [peer, playerInfo] : players) {
+            if (round < playerInfo.movementInputs.size()) {
+                movers.push_back(&playerInfo);
+                moverPositions.push_back(playerInfo.position);
+                moverInputs.push_back(playerInfo.movementInputs[round]);
+            }
+        }
+        if (movers.empty()) {
+            break;
+        }
+
+        batchApplyMovement(moverPositions, moverInputs);
+        for (size_t i = 0; i < movers.size(); ++i) {
+            movers[i]->position = moverPositions[i];
+            movers[i]->dirty = true;
+        }
+    }
+
+    for (auto& [peer, playerInfo] : players) {
+        playerInfo.movementInputs.clear();
+    }
+}
+
+void GameServer::ResolveCollisions() {
+    PROFILE_FUNCTION();
+    bodyPositions.clear();
+    bodies.clear();
+    for (auto& [peer, playerInfo] : players) {
+        if (playerInfo.id != INVALID_PLAYER_ID) {
+            bodies.push_back(&playerInfo);
+        }
+    }
+    // The map's order depends on peer addresses; ordering by id makes every run push bodies the same way.
+    std::sort(bodies.begin(), bodies.end(), [](const PlayerInfo* a, const PlayerInfo* b) { return a->id < b->id; });
+    for (const PlayerInfo* playerInfo : bodies) {
+        bodyPositions.push_back(toFloat(playerInfo->position));
+    }
+    collision.resolve(bodyPositions, PLAYER_RADIUS);
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        // Only pushed bodies are converted back; far from the origin a round trip through float is not exact.
+        PlayerInfo& playerInfo = *bodies[i];
+        EVec before = toFloat(playerInfo.position);
+        if (std::memcmp(&before, &bodyPositions[i], sizeof(EVec)) != 0) {
+            playerInfo.position = clampToWorld(toFixed<WorldFixed>(bodyPositions[i]));
+            playerInfo.dirty = true;
+        }
+    }
+}
+
+/// @brief Queues a packet on CHANNEL_WORLD, destroying it if it could not be queued.
+static void SendWorldPacket(ENetPeer* peer, ENetPacket* packet) {
+    if (enet_peer_send(peer, CHANNEL_WORLD, packet) != 0) {
+        enet_packet_destroy(packet);
+    }
+}
+
+void GameServer::StreamChunks() {
+    PROFILE_FUNCTION();
+    for (auto& [peer, playerInfo] : players) {
+        if (playerInfo.id == INVALID_PLAYER_ID) {
+            continue;
+        }
+
+        ChunkCoord center = chunkCoordAt(toFloat(playerInfo.position));
+        if (center.x != playerInfo.streamCenter.x || center.y != playerInfo.streamCenter.y) {
+            playerInfo.streamCenter = center;
+            playerInfo.streamComplete = false;
+
+            std::vector<ChunkCoord> unload;
+            std::erase_if(playerInfo.loadedChunks, [&](uint64_t key) {
+                ChunkCoord coord = {int32_t(uint32_t(key >> 32)), int32_t(uint32_t(key))};
+                if (std::max(std::abs(coord.x - center.x), std::abs(coord.y - center.y)) <= CHUNK_UNLOAD_RADIUS) {
+                    return false;
+                }
+                unload.push_back(coord);
+                return true;
+            });
+            if (!unload.empty()) {
+                ChunkUnloadHeader header = {WORLD_MESSAGE_UNLOAD, 0, uint16_t(unload.size())};
+                ENetPacket* packet = enet_packet_create(NULL, sizeof(header) + unload.size() * sizeof(ChunkCoord), ENET_PACKET_FLAG_RELIABLE);
+                std::memcpy(packet->data, &header, sizeof(header));
+                std::memcpy(packet->data + sizeof(header), unload.data(), unload.size() * sizeof(ChunkCoord));
+                SendWorldPacket(peer, packet);
+            }
+        }
+
+        if (!playerInfo.streamComplete) {
+            SendMissingChunks(peer, playerInfo);
+        }
+    }
+}
+
+void GameServer::SendMissingChunks(ENetPeer* peer, PlayerInfo& playerInfo) {
+    int sent = 0;
+    ChunkCoord center = playerInfo.streamCenter;
+    // Ring by ring, so the chunk the player stands in arrives first.
+    for (int radius = 0; radius <= CHUNK_VIEW_RADIUS; ++radius) {
+        for (int dy = -radius; dy <= radius; ++dy) {
+            for (int dx = -radius; dx <= radius; ++dx) {
+                if (std::max(std::abs(dx), std::abs(dy)) != radius) {
+                    continue;
+                }
+                ChunkCoord coord = {center.x + dx, center.y + dy};
+                if (playerInfo.loadedChunks.contains(chunkKey(coord))) {
+                    continue;
+                }
+                if (sent == CHUNK_SENDS_PER_TICK) {
+                    return;  // The rest follows next tick.
+                }
+                playerInfo.loadedChunks.insert(chunkKey(coord));
+
+                std::span<const TileRun> runs = world.getEncodedChunk(coord, tickNumber);
+                ChunkDataHeader header = {WORLD_MESSAGE_CHUNK, 0, uint16_t(runs.size()), coord};
+                ENetPacket* packet = enet_packet_create(NULL, sizeof(header) + runs.size_bytes(), ENET_PACKET_FLAG_RELIABLE);
+                std::memcpy(packet->data, &header, sizeof(header));
+                std::memcpy(packet->data + sizeof(header), runs.data(), runs.size_bytes());
+                SendWorldPacket(peer, packet);
+                ++sent;
+            }
+        }
+    }
+    playerInfo.streamComplete = true;
+}
+
+bool GameServer::SetTile(int32_t tileX, int32_t tileY, TileId tile) {
+    if (!world.setTile(tileX, tileY, tile, tickNumber)) {
+        return false;
+    }
+
+    // One packet shared by every player holding the chunk.
+    uint64_t key = chunkKey(chunkCoordOfTile(tileX, tileY));
+    TileUpdate update = {WORLD_MESSAGE_TILE, 0, tile, tileX, tileY};
+    ENetPacket* packet = enet_packet_create(&update, sizeof(update), ENET_PACKET_FLAG_RELIABLE);
+    for (auto& [peer, playerInfo] : players) {
+        if (playerInfo.loadedChunks.contains(key)) {
+            enet_peer_send(peer, CHANNEL_WORLD, packet);
+        }
+    }
+    if (packet->referenceCount == 0) {
+        enet_packet_destroy(packet);
+    }
+    return true;
+}
+
+TileWorld& GameServer::getTileWorld() {
+    return world;
+}
+
+void GameServer::FlushChat() {
+    PROFILE_FUNCTION();
+    ENetPacket* packet = chat.takeBatch();
+    if (packet == nullptr) {
+        return;
+    }
+    // One packet shared by every player, however many messages it holds.
+    for (auto& [peer, playerInfo] : players) {
+        if (playerInfo.id != INVALID_PLAYER_ID) {
+            enet_peer_send(peer, CHANNEL_CHAT, packet);
+        }
+    }
+    if (packet->referenceCount == 0) {
+        enet_packet_destroy(packet);
+    }
+}
+
+uint32_t GameServer::CreateContainer(int rows, int cols) {
+    uint32_t containerId = nextContainerId++;
+    containers.emplace(containerId, WorldContainer{Inventory(rows, cols), {}});
+    return containerId;
+}
+
+Inventory* GameServer::getContainerInventory(uint32_t containerId) {
+    auto it = containers.find(containerId);
+    return it != containers.end() ? &it->second.inventory : nullptr;
+}
+
+PlayerRecord GameServer::ToRecord(const PlayerInfo& playerInfo) {
+    return PlayerRecord{playerInfo.id, playerInfo.resumeToken, toFloat(playerInfo.position), playerInfo.color, playerInfo.health, playerInfo.inventory, playerInfo.chatTokens};
+}
+
+void GameServer::CheckpointPlayers() {
+    PROFILE_FUNCTION();
+    for (auto& pair : players) {
+        PlayerInfo& playerInfo = pair.second;
+        if (playerInfo.dirty && playerInfo.id != INVALID_PLAYER_ID) {
+            persistence.stage(ToRecord(playerInfo));
+            playerInfo.dirty = false;
+        }
+    }
+    persistence.commit();
+}
+
+ENetPacket* GameServer::CreateSnapshotPacket() const {
+    PROFILE_FUNCTION();
+    std::vector<std::pair<EVec, PlayerColor>> playerData;
+
+    for (auto& player : players) {
+        playerData.push_back({toFloat(player.second.position), player.second.color});
+    }
+
+    return enet_packet_create(playerData.data(), playerData.size() * sizeof(std::pair<EVec, PlayerColor>), ENET_PACKET_FLAG_RELIABLE);
+}
+
+void GameServer::BroadcastPlayerStates() {
+    PROFILE_FUNCTION();
+    // Broadcast all player positions to all clients
+    for (auto& pair : players) {
+        ENetPeer* peer = pair.first;
+        ENetPacket* packet = CreateSnapshotPacket();
+        if (enet_peer_send(peer, 0, packet) != 0) {
+            enet_packet_destroy(packet);
+        }
+    }
+}
+
+void GameServer::SetAdmissionConfig(const AdmissionConfig& config) {
+    admission.setConfig(config);
+    if (host != nullptr) {
+        admission.configureHost(host);
+    }
+}
+
+ServerState GameServer::getState() const {
+    return state;
+}
+
+ENetHost* GameServer::getHost() const {
+    return host;
+}
+
+std::unordered_map<ENetPeer*, PlayerInfo>& GameServer::getPlayers() {
+    return players;
+}
+
+CollisionWorld& GameServer::getCollisionWorld() {
+    return collision;
+}
+
+MetricsRegistry& GameServer::getMetrics() {
+    return metrics;
+}
+
+const std::unordered_map<uint32_t, PlayerRecord>& GameServer::getSavedPlayers() const {
+    return savedPlayers;
+}
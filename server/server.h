@@ -0,0 +1,295 @@
+#pragma once
+
+#include <enet.h>
+#include "engine.h"
+#include "admission.h"
+#include "chat.h"
+#include "collision.h"
+#include "crafting.h"
+#include "metrics.h"
+#include "persistence.h"
+#include "protocol.h"
+#include "tilemap.h"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#define SERVER_PORT 6777
+#define SERVER_MAX_CLIENTS 32
+#define SERVER_CHANNEL_COUNT 5
+#define SLEEP_MS 10
+#define SERVER_WORLD_DIRECTORY "world"
+#define PERSIST_INTERVAL_TICKS 10
+#define SERVER_DRAIN_TIMEOUT_MS 1000
+#define PLAYER_MAX_HEALTH 100.0f
+#define PLAYER_INVENTORY_ROWS 4
+#define PLAYER_INVENTORY_COLS 9
+#define CRAFTING_GRID_ROWS 3
+#define CRAFTING_GRID_COLS 3
+#define CHUNK_VIEW_RADIUS 2           // Chunks up to this many chunks away (Chebyshev) from a player are sent to them.
+#define CHUNK_UNLOAD_RADIUS 3         // Chunks further away are unloaded; the gap keeps chunk borders from thrashing.
+#define CHUNK_SENDS_PER_TICK 4        // At most this many chunks per player per tick, nearest first.
+#define CHUNK_CACHE_IDLE_TICKS 600    // Unchanged chunks no player was sent for this long are dropped from the cache.
+
+/// @brief The server side state of a connected player.
+struct PlayerInfo {
+    WorldVec position = {WorldFixed(960), WorldFixed(540)};   // The player's position, simulated in fixed point.
+    PlayerColor color = {};             // The color the client picked.
+    bool hasColor = false;              // Whether the client already sent its color (its first packet).
+    uint32_t id = INVALID_PLAYER_ID;    // Persistent id, assigned once the client has joined.
+    uint64_t resumeToken = 0;           // The secret the client must send to resume this player later.
+    float health = PLAYER_MAX_HEALTH;   // The player's health.
+    Inventory inventory{PLAYER_INVENTORY_ROWS, PLAYER_INVENTORY_COLS};
+    Inventory craftingGrid{CRAFTING_GRID_ROWS, CRAFTING_GRID_COLS};   // Not saved; emptied into the inventory on close.
+    CraftingPreview craftingPreview{};  // What the crafting grid makes.
+    uint32_t openContainer = CONTAINER_PLAYER;   // The world container the player has open, CONTAINER_PLAYER if none.
+    TokenBucket chatTokens{0, CHAT_BURST};       // The player's chat rate limit, carried over when they resume.
+    std::unordered_set<uint64_t> loadedChunks{};   // chunkKey() of every chunk the client holds.
+    ChunkCoord streamCenter = {INT32_MIN, INT32_MIN};   // The chunk the player was in when streaming last caught up.
+    bool streamComplete = false;        // Whether every chunk within CHUNK_VIEW_RADIUS of streamCenter was sent.
+    std::vector<WorldVec> movementInputs{};   // Movement received this tick, in order, until IntegrateMovement applies it.
+    bool dirty = false;                 // Changed since the last checkpoint.
+};
+
+/// @brief A container placed in the world, such as a chest, and the peers viewing it.
+struct WorldContainer {
+    Inventory inventory;                // The container's contents.
+    std::vector<ENetPeer*> viewers;     // Peers that have it open and receive its deltas.
+};
+
+/// @brief The per-peer connection gauges, looked up once when the peer connects.
+struct PeerMetrics {
+    Gauge* roundTripTime;
+    Gauge* roundTripTimeVariance;
+    Gauge* packetLoss;
+    Gauge* packetsLost;
+    Gauge* packetThrottle;
+    Gauge* reliableDataInTransit;
+    Gauge* outgoingReliableCommands;
+    Gauge* outgoingUnreliableCommands;
+    Gauge* sentReliableCommands;
+};
+
+/// @brief The game server: owns the ENet host and the state of every connected player.
+class GameServer {
+private:
+    /// @brief The ENet host clients connect to.
+    ENetHost* host;
+
+    /// @brief Map of connected players and their states.
+    std::unordered_map<ENetPeer*, PlayerInfo> players;
+
+    /// @brief Saved state of every player that is not connected, keyed by player id.
+    std::unordered_map<uint32_t, PlayerRecord> savedPlayers;
+
+    /// @brief Writes player state to disk in the background.
+    WorldPersistence persistence;
+
+    /// @brief The id given to the next new player.
+    uint32_t nextPlayerId;
+
+    /// @brief Ticks run since the server started.
+    uint64_t tickNumber;
+
+    /// @brief The lifecycle state of the server.
+    ServerState state;
+
+    /// @brief Server metrics, sampled every tick.
+    MetricsRegistry metrics;
+    Histogram& tickSeconds;
+    Counter& ticksTotal;
+    Counter& sentBytesTotal;
+    Counter& sentPacketsTotal;
+    Counter& receivedBytesTotal;
+    Counter& receivedPacketsTotal;
+    Gauge& connectedPeers;
+    Gauge& playerCount;
+    std::unordered_map<ENetPeer*, PeerMetrics> peerMetrics;
+
+    /// @brief Rate limits and pre-filters datagrams in the host's intercept callback, and
+    /// drops connection attempts unless the server is OPEN, all before ENet allocates a peer.
+    ConnectionAdmission admission;
+
+    /// @brief Containers placed in the world, keyed by container id.
+    std::unordered_map<uint32_t, WorldContainer> containers;
+
+    /// @brief The id given to the next world container.
+    uint32_t nextContainerId;
+
+    Counter& inventoryTransactionsAccepted;
+    Counter& inventoryTransactionsRejected;
+
+    /// @brief Chat messages waiting for the end of the tick, and the recent history.
+    ChatRelay chat;
+
+    // Scratch for IntegrateMovement, reused every tick.
+    std::vector<PlayerInfo*> movers;        // The player owning each entry of moverPositions.
+    std::vector<WorldVec> moverPositions;
+    std::vector<WorldVec> moverInputs;
+
+    /// @brief Keeps players apart and out of the world's obstacles.
+    CollisionWorld collision;
+    std::vector<EVec> bodyPositions;    // Scratch for ResolveCollisions, reused every tick.
+    std::vector<PlayerInfo*> bodies;    // The player owning each entry of bodyPositions, ordered by id.
+
+    /// @brief The tile world and the cache of its chunks.
+    TileWorld world;
+
+    /// @brief Moves ENet's traffic totals into the counters and samples every peer's connection state.
+    void SampleMetrics();
+
+    /// @brief Gets the label set identifying a peer in per-peer metrics.
+    static std::string PeerLabels(const ENetPeer* peer);
+
+    /// @brief Creates the per-peer gauges for a newly connected peer.
+    PeerMetrics CreatePeerMetrics(const ENetPeer* peer);
+
+    /// @brief Moves the server to another lifecycle state.
+    /// Only STARTING -> OPEN, STARTING -> CLOSING and OPEN -> CLOSING are allowed.
+    /// @return True if the transition was allowed.
+    bool SetState(ServerState next);
+
+    /// @brief Handles a client's first packet: resumes or creates its player and sends the welcome.
+    void JoinPlayer(ENetPeer* peer, PlayerInfo& playerInfo, const ENetPacket* packet);
+
+    /// @brief Handles a message on CHANNEL_INVENTORY from a player that has joined.
+    void HandleInventoryMessage(ENetPeer* peer, PlayerInfo& playerInfo, const ENetPacket* packet);
+
+    /// @brief Applies an InventoryTransaction and sends its result.
+    void ApplyInventoryTransaction(ENetPeer* peer, PlayerInfo& playerInfo, const InventoryTransaction& transaction);
+
+    /// @brief Crafts from a player's crafting grid into their inventory and sends the result.
+    void CraftFromGrid(ENetPeer* peer, PlayerInfo& playerInfo, const InventoryCraftRequest& request);
+
+    /// @brief Moves everything in a player's crafting grid back into their inventory, as far as it fits.
+    void EmptyCraftingGrid(PlayerInfo& playerInfo);
+
+    /// @brief Finds a container a player may change: their own inventory, their crafting grid, or the world container they have open.
+    /// @return The container's inventory, or nullptr if the player does not have it open.
+    Inventory* FindOpenInventory(PlayerInfo& playerInfo, uint32_t containerId);
+
+    /// @brief Opens a container for a player and sends them all of its slots.
+    void OpenContainer(ENetPeer* peer, PlayerInfo& playerInfo, uint32_t containerId);
+
+    /// @brief Closes the world container a player has open, if any.
+    void CloseContainer(ENetPeer* peer, PlayerInfo& playerInfo);
+
+    /// @brief Creates an INVENTORY_MESSAGE_SYNC packet holding every slot of a container.
+    static ENetPacket* CreateInventorySyncPacket(uint32_t containerId, const Inventory& inventory);
+
+    /// @brief Creates an INVENTORY_MESSAGE_DELTA packet holding the dirty slots of a container.
+    static ENetPacket* CreateInventoryDeltaPacket(uint32_t containerId, const Inventory& inventory);
+
+    /// @brief Copies a player into a record for saving.
+    static PlayerRecord ToRecord(const PlayerInfo& playerInfo);
+
+    /// @brief Stages every player that changed since the last checkpoint and hands them to the writer.
+    void CheckpointPlayers();
+
+public:
+    /// @brief Loads the saved world and enables persistence. Only allowed while STARTING.
+    /// Without a world, players are not saved.
+    /// @param directory The directory holding the world files.
+    /// @return True if the world was loaded or created.
+    bool OpenWorld(const std::string& directory = SERVER_WORLD_DIRECTORY);
+
+    /// @brief Initializes ENet and creates the host. The server stays STARTING, so
+    /// connection attempts are dropped until Open() is called.
+    /// @param port The UDP port to listen on.
+    /// @return True if the server started, false otherwise.
+    bool Start(enet_uint16 port = SERVER_PORT);
+
+    /// @brief Finishes starting up and begins accepting clients (STARTING -> OPEN).
+    /// @return True if the server was STARTING and is now OPEN.
+    bool Open();
+
+    /// @brief Runs one server tick: handles every pending network event, then broadcasts player states.
+    void Tick();
+
+    /// @brief Saves every player, closes the world, destroys the host and shuts ENet down.
+    void Stop();
+
+    /// @brief Shuts down gracefully: stops accepting clients, disconnects every peer, waits for
+    /// queued packets and disconnects to go out, then saves the world and calls Stop().
+    /// @param drainTimeoutMs How long to wait for peers to acknowledge the disconnect before dropping them.
+    void Shutdown(enet_uint32 drainTimeoutMs = SERVER_DRAIN_TIMEOUT_MS);
+
+    /// @brief Handles a single ENet event (connect, receive or disconnect).
+    /// @param event The event returned by enet_host_service.
+    void HandleEvent(ENetEvent& event);
+
+    /// @brief Sends the slots that changed this tick: each player's own inventory to that
+    /// player, and each world container to everyone viewing it. One packet per container.
+    void ReplicateInventories();
+
+    /// @brief Applies the movement every player sent this tick, with batchApplyMovement().
+    void IntegrateMovement();
+
+    /// @brief Pushes the players that joined out of each other and out of the obstacles.
+    void ResolveCollisions();
+
+    /// @brief Sends every player the chunks that came into view and unloads the ones they left behind.
+    void StreamChunks();
+
+    /// @brief Sends a player up to CHUNK_SENDS_PER_TICK chunks they do not have, nearest first.
+    void SendMissingChunks(ENetPeer* peer, PlayerInfo& playerInfo);
+
+    /// @brief Sends the chat messages posted this tick to every player that has joined, as one packet.
+    void FlushChat();
+
+    /// @brief Places an empty container in the world.
+    /// @param rows The number of rows.
+    /// @param cols The number of columns.
+    /// @return The id clients use to open it.
+    uint32_t CreateContainer(int rows, int cols);
+
+    /// @brief Gets a world container's contents. Changes are sent to its viewers on the next tick.
+    /// @param containerId The container's id.
+    /// @return The container's inventory, or nullptr if there is no such container.
+    Inventory* getContainerInventory(uint32_t containerId);
+
+    /// @brief Changes a tile and sends it to every player holding its chunk.
+    /// @return True if the tile changed.
+    bool SetTile(int32_t tileX, int32_t tileY, TileId tile);
+
+    /// @brief Gets the tile world.
+    TileWorld& getTileWorld();
+
+    /// @brief Gets the collision world, to add the world's obstacles.
+    CollisionWorld& getCollisionWorld();
+
+    /// @brief Sends the state of every player to every connected client.
+    void BroadcastPlayerStates();
+
+    /// @brief Creates the snapshot packet holding the position and color of every player.
+    /// @return A new reliable packet, owned by the caller until it is sent.
+    ENetPacket* CreateSnapshotPacket() const;
+
+    /// @brief Changes the admission limits, including the host's per-address peer limit.
+    /// @param config The new limits.
+    void SetAdmissionConfig(const AdmissionConfig& config);
+
+    /// @brief Gets the lifecycle state of the server.
+    /// @return The current ServerState.
+    ServerState getState() const;
+
+    /// @brief Gets the ENet host.
+    /// @return The host, or nullptr if the server is not running.
+    ENetHost* getHost() const;
+
+    /// @brief Gets the connected players.
+    /// @return A reference to the map of players keyed by their peer.
+    std::unordered_map<ENetPeer*, PlayerInfo>& getPlayers();
+
+    /// @brief Gets the server metrics.
+    /// @return A reference to the registry, for rendering or adding metrics.
+    MetricsRegistry& getMetrics();
+
+    /// @brief Gets the saved state of players that are not connected.
+    /// @return A reference to the map of saved players keyed by player id.
+    const std::unordered_map<uint32_t, PlayerRecord>& getSavedPlayers() const;
+
+    GameServer();
+};
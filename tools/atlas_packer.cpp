@@ -0,0 +1,213 @@
+// atlas_packer: packs every PNG under an assets directory into one or more
+// texture atlas pages and writes a JSON lookup table of the packed regions.
+//
+// Usage: atlas_packer <assets dir> <output dir> [max page size] [padding]
+//
+// Region names are the image paths relative to the assets directory, without
+// the extension (e.g. "player/player_icon"). The output directory is skipped
+// while scanning, so it can live inside the assets directory.
+
+#include <raylib.h>
+#include <picojson.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define DEFAULT_MAX_PAGE_SIZE 2048
+#define DEFAULT_PADDING 2
+#define ATLAS_TABLE_NAME "atlas.json"
+
+struct SourceImage {
+    std::string name;
+    Image image;
+    int page;
+    int x;
+    int y;
+};
+
+static int nextPowerOfTwo(int value) {
+    int result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+/// @brief Gets the side of a page whose content is used pixels long: a power of two when
+/// that fits, since some GPUs still prefer them, otherwise exactly the maximum page size.
+static int pageDimension(int used, int maxSize) {
+    return std::min(nextPowerOfTwo(used), maxSize);
+}
+
+/// @brief Packs images into pages using shelves sorted by height.
+/// @return The number of pages used, or -1 if an image does not fit on an empty page.
+static int packShelves(std::vector<SourceImage>& images, int maxSize, int padding,
+                       std::vector<std::pair<int, int>>& pageSizes) {
+    std::sort(images.begin(), images.end(), [](const SourceImage& a, const SourceImage& b) {
+        return a.image.height != b.image.height ? a.image.height > b.image.height : a.name < b.name;
+    });
+
+    int page = 0;
+    int shelfX = padding;
+    int shelfY = padding;
+    int shelfHeight = 0;
+    int usedWidth = 0;
+    pageSizes.clear();
+
+    for (SourceImage& source : images) {
+        int width = source.image.width;
+        int height = source.image.height;
+        if (width + 2 * padding > maxSize || height + 2 * padding > maxSize) {
+            std::cerr << "Image is larger than the maximum atlas size: " << source.name << std::endl;
+            return -1;
+        }
+
+        if (shelfX + width + padding > maxSize) {
+            // Start a new shelf below the current one.
+            shelfX = padding;
+            shelfY += shelfHeight + padding;
+            shelfHeight = 0;
+        }
+        if (shelfY + height + padding > maxSize) {
+            // Page is full, start a new one.
+            pageSizes.push_back({pageDimension(usedWidth, maxSize), pageDimension(shelfY + shelfHeight + padding, maxSize)});
+            page++;
+            shelfX = padding;
+            shelfY = padding;
+            shelfHeight = 0;
+            usedWidth = 0;
+        }
+
+        source.page = page;
+        source.x = shelfX;
+        source.y = shelfY;
+        shelfX += width + padding;
+        shelfHeight = std::max(shelfHeight, height);
+        usedWidth = std::max(usedWidth, shelfX);
+    }
+
+    if (!images.empty()) {
+        pageSizes.push_back({pageDimension(usedWidth, maxSize), pageDimension(shelfY + shelfHeight + padding, maxSize)});
+    }
+    return int(pageSizes.size());
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 5) {
+        std::cerr << "Usage: " << argv[0] << " <assets dir> <output dir> [max page size] [padding]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::path assetsDir = argv[1];
+    std::filesystem::path outputDir = argv[2];
+    int maxSize = argc > 3 ? std::atoi(argv[3]) : DEFAULT_MAX_PAGE_SIZE;
+    int padding = argc > 4 ? std::atoi(argv[4]) : DEFAULT_PADDING;
+
+    SetTraceLogLevel(LOG_WARNING);
+
+    std::error_code ec;
+    std::filesystem::path outputCanonical = std::filesystem::weakly_canonical(outputDir, ec);
+
+    std::vector<SourceImage> images;
+    for (auto it = std::filesystem::recursive_directory_iterator(assetsDir, ec);
+         it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (ec) {
+            break;
+        }
+        if (it->is_directory() && std::filesystem::weakly_canonical(it->path(), ec) == outputCanonical) {
+            it.disable_recursion_pending();
+            continue;
+        }
+        if (!it->is_regular_file() || it->path().extension() != ".png") {
+            continue;
+        }
+
+        Image image = LoadImage(it->path().string().c_str());
+        if (image.data == nullptr) {
+            std::cerr << "Failed to load image: " << it->path().string() << std::endl;
+            return EXIT_FAILURE;
+        }
+        ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+        std::filesystem::path name = std::filesystem::relative(it->path(), assetsDir).replace_extension();
+        images.push_back(SourceImage{name.generic_string(), image, 0, 0, 0});
+    }
+    if (ec) {
+        std::cerr << "Failed to scan assets directory " << assetsDir.string() << ": " << ec.message() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::pair<int, int>> pageSizes;
+    int pageCount = packShelves(images, maxSize, padding, pageSizes);
+    if (pageCount < 0) {
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::create_directories(outputDir, ec);
+
+    picojson::array pages;
+    for (int page = 0; page < pageCount; ++page) {
+        Image atlas = GenImageColor(pageSizes[page].first, pageSizes[page].second, BLANK);
+        for (const SourceImage& source : images) {
+            if (source.page == page) {
+                Rectangle rect = {0, 0, float(source.image.width), float(source.image.height)};
+                Rectangle dest = {float(source.x), float(source.y), rect.width, rect.height};
+                ImageDraw(&atlas, source.image, rect, dest, WHITE);
+            }
+        }
+
+        std::string pageName = "atlas" + std::to_string(page) + ".png";
+        if (!ExportImage(atlas, (outputDir / pageName).string().c_str())) {
+            std::cerr << "Failed to write atlas page: " << (outputDir / pageName).string() << std::endl;
+            UnloadImage(atlas);
+            return EXIT_FAILURE;
+        }
+        UnloadImage(atlas);
+
+        picojson::object pageObj;
+        pageObj["file"] = picojson::value(pageName);
+        pageObj["width"] = picojson::value(double(pageSizes[page].first));
+        pageObj["height"] = picojson::value(double(pageSizes[page].second));
+        pages.push_back(picojson::value(pageObj));
+    }
+
+    // Pixel rectangles are what raylib draws with, UVs are kept for custom shaders.
+    picojson::object regions;
+    for (const SourceImage& source : images) {
+        float pageWidth = float(pageSizes[source.page].first);
+        float pageHeight = float(pageSizes[source.page].second);
+
+        picojson::object regionObj;
+        regionObj["page"] = picojson::value(double(source.page));
+        regionObj["x"] = picojson::value(double(source.x));
+        regionObj["y"] = picojson::value(double(source.y));
+        regionObj["width"] = picojson::value(double(source.image.width));
+        regionObj["height"] = picojson::value(double(source.image.height));
+        regionObj["u0"] = picojson::value(double(source.x / pageWidth));
+        regionObj["v0"] = picojson::value(double(source.y / pageHeight));
+        regionObj["u1"] = picojson::value(double((source.x + source.image.width) / pageWidth));
+        regionObj["v1"] = picojson::value(double((source.y + source.image.height) / pageHeight));
+        regions[source.name] = picojson::value(regionObj);
+
+        UnloadImage(source.image);
+    }
+
+    picojson::object table;
+    table["pages"] = picojson::value(pages);
+    table["regions"] = picojson::value(regions);
+
+    std::ofstream file(outputDir / ATLAS_TABLE_NAME);
+    if (!file.is_open()) {
+        std::cerr << "Failed to write atlas table: " << (outputDir / ATLAS_TABLE_NAME).string() << std::endl;
+        return EXIT_FAILURE;
+    }
+    file << picojson::value(table).serialize(true);
+
+    std::cout << "Packed " << images.size() << " images into " << pageCount << " atlas page(s) in "
+              << outputDir.string() << std::endl;
+    return EXIT_SUCCESS;
+}
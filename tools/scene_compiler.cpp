@@ -0,0 +1,57 @@
+// scene_compiler: compiles a JSON scene into the binary scene format
+// described in scene_format.h, so the client can mmap it instead of parsing JSON.
+//
+// Usage: scene_compiler <scene.json> [output.scene]
+
+#include <scene_format.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <scene.json> [output" SCENE_BINARY_EXTENSION "]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::path inputPath = argv[1];
+    std::filesystem::path outputPath = argc == 3 ? std::filesystem::path(argv[2])
+                                                 : std::filesystem::path(inputPath).replace_extension(SCENE_BINARY_EXTENSION);
+
+    std::ifstream input(inputPath);
+    if (!input.is_open()) {
+        std::cerr << "Failed to open scene file: " << inputPath.string() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::stringstream buffer;
+    buffer << input.rdbuf();
+    std::string json = buffer.str();
+
+    std::vector<unsigned char> out;
+    std::string err;
+    if (!compileScene(json.data(), json.size(), out, err)) {
+        std::cerr << "Failed to compile " << inputPath.string() << ": " << err << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+    if (!output.is_open()) {
+        std::cerr << "Failed to open output file: " << outputPath.string() << std::endl;
+        return EXIT_FAILURE;
+    }
+    output.write(reinterpret_cast<const char*>(out.data()), std::streamsize(out.size()));
+    if (!output) {
+        std::cerr << "Failed to write output file: " << outputPath.string() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Compiled " << inputPath.string() << " -> " << outputPath.string()
+              << " (" << reinterpret_cast<const SceneBinaryHeader*>(out.data())->textEntityCount
+              << " entities, " << out.size() << " bytes)" << std::endl;
+    return EXIT_SUCCESS;
+}